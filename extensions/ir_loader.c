@@ -0,0 +1,170 @@
+#include "ir_loader.h"
+
+#include "latency_probe.h"
+
+#define LOADER_QUEUE_SIZE 8
+#define LOADER_STACK_SIZE 2048
+
+typedef enum {
+    LoaderCommandStage,
+    LoaderCommandPress,
+    LoaderCommandRelease,
+    LoaderCommandMacroStep,
+    LoaderCommandUnstage,
+    LoaderCommandQuit,
+} LoaderCommand;
+
+typedef struct {
+    LoaderCommand command;
+    const Remote* remote;
+    uint32_t index;
+    RepeatPolicy policy;
+    MacroRunner* macro;
+} LoaderMessage;
+
+struct SignalLoader {
+    FuriThread* thread;
+    FuriMessageQueue* queue;
+    /*latest selection not staged yet, STAGED_NONE when there is none. a stage message is
+    only queued when this was empty, so scrolling past buttons stages just the last one*/
+    uint32_t pendingStage;
+    //remote of pendingStage, written before it is published
+    const Remote* stageRemote;
+    //released by the loader thread once an unstage is done
+    FuriSemaphore* unstaged;
+    Transmitter* transmitter;
+    //a press started TX and it wasn't stopped since, only used by the loader thread
+    bool sending;
+    LoaderStartCallback started;
+    LoaderStopCallback stopped;
+    void* context;
+};
+
+//stops TX, telling the app if a press had started it
+void loaderStop(SignalLoader* loader) {
+    stopSignal(loader->transmitter);
+    if(loader->sending) {
+        loader->sending = false;
+        if(loader->stopped) {
+            loader->stopped(loader->context);
+        }
+    }
+}
+
+int32_t loaderThread(void* context) {
+    SignalLoader* loader = context;
+    Transmitter* transmitter = loader->transmitter;
+    LoaderMessage message;
+    while(true) {
+        //a streamed signal being sent has to be topped up while waiting
+        uint32_t timeout = transmitterPoll(transmitter) ? RAW_STREAM_POLL_MS : FuriWaitForever;
+        FuriStatus status = furi_message_queue_get(loader->queue, &message, timeout);
+        if(status == FuriStatusErrorTimeout) {
+            continue;
+        }
+        furi_check(status == FuriStatusOk);
+        switch(message.command) {
+        case LoaderCommandStage: {
+            uint32_t index =
+                __atomic_exchange_n(&loader->pendingStage, STAGED_NONE, __ATOMIC_ACQUIRE);
+            if(index != STAGED_NONE) {
+                stageSignal(transmitter, loader->stageRemote, index);
+            }
+            break;
+        }
+        case LoaderCommandPress:
+            if(startSignal(transmitter, message.remote, message.index, &message.policy)) {
+                loader->sending = true;
+                if(loader->started) {
+                    loader->started(loader->context);
+                }
+            }
+            LATENCY_END(LatencyTrackPress);
+            break;
+        case LoaderCommandRelease:
+            loaderStop(loader);
+            break;
+        case LoaderCommandMacroStep:
+            //steps are sent around the transmitter, it has to be idle and off the scratch
+            loaderStop(loader);
+            finishStream(transmitter);
+            macroStep(message.macro);
+            break;
+        case LoaderCommandUnstage:
+            __atomic_store_n(&loader->pendingStage, STAGED_NONE, __ATOMIC_RELAXED);
+            loaderStop(loader);
+            unstageSignal(transmitter);
+            furi_semaphore_release(loader->unstaged);
+            break;
+        case LoaderCommandQuit:
+            stopSignal(transmitter);
+            unstageSignal(transmitter);
+            return 0;
+        }
+    }
+}
+void loaderPut(SignalLoader* loader, const LoaderMessage* message) {
+    furi_check(furi_message_queue_put(loader->queue, message, FuriWaitForever) == FuriStatusOk);
+}
+SignalLoader* loaderAlloc(
+    Transmitter* transmitter,
+    LoaderStartCallback started,
+    LoaderStopCallback stopped,
+    void* context) {
+    SignalLoader* loader = malloc(sizeof(SignalLoader));
+    loader->queue = furi_message_queue_alloc(LOADER_QUEUE_SIZE, sizeof(LoaderMessage));
+    loader->unstaged = furi_semaphore_alloc(1, 0);
+    loader->pendingStage = STAGED_NONE;
+    loader->stageRemote = NULL;
+    loader->transmitter = transmitter;
+    loader->sending = false;
+    loader->started = started;
+    loader->stopped = stopped;
+    loader->context = context;
+    loader->thread =
+        furi_thread_alloc_ex("FancyRemoteLoader", LOADER_STACK_SIZE, loaderThread, loader);
+    //presses are started here, so the thread runs ahead of the GUI
+    furi_thread_set_priority(loader->thread, FuriThreadPriorityHigh);
+    furi_thread_start(loader->thread);
+    return loader;
+}
+void loaderFree(SignalLoader* loader) {
+    const LoaderMessage message = {.command = LoaderCommandQuit};
+    loaderPut(loader, &message);
+    furi_thread_join(loader->thread);
+    furi_thread_free(loader->thread);
+    furi_semaphore_free(loader->unstaged);
+    furi_message_queue_free(loader->queue);
+    free(loader);
+}
+void loaderStage(SignalLoader* loader, const Remote* remote, uint32_t index) {
+    //the remote only changes after loaderUnstage, when no stage is pending
+    loader->stageRemote = remote;
+    if(__atomic_exchange_n(&loader->pendingStage, index, __ATOMIC_RELEASE) == STAGED_NONE) {
+        const LoaderMessage message = {.command = LoaderCommandStage};
+        loaderPut(loader, &message);
+    }
+}
+void loaderPress(
+    SignalLoader* loader,
+    const Remote* remote,
+    uint32_t index,
+    const RepeatPolicy* policy) {
+    const LoaderMessage message = {
+        .command = LoaderCommandPress, .remote = remote, .index = index, .policy = *policy};
+    loaderPut(loader, &message);
+}
+void loaderRelease(SignalLoader* loader) {
+    const LoaderMessage message = {.command = LoaderCommandRelease};
+    loaderPut(loader, &message);
+}
+bool loaderMacroStep(SignalLoader* loader, MacroRunner* runner) {
+    //called from the timer thread, which must not wait for the queue
+    const LoaderMessage message = {.command = LoaderCommandMacroStep, .macro = runner};
+    return furi_message_queue_put(loader->queue, &message, 0) == FuriStatusOk;
+}
+void loaderUnstage(SignalLoader* loader) {
+    const LoaderMessage message = {.command = LoaderCommandUnstage};
+    loaderPut(loader, &message);
+    furi_semaphore_acquire(loader->unstaged, FuriWaitForever);
+}
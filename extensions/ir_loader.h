@@ -0,0 +1,104 @@
+/**
+ * @file ir_loader.h
+ * Runs a Transmitter on its own thread, so the input path never waits on the SD card
+ *
+ * Staging a streamed signal opens its .ir file, which is too slow for the view
+ * dispatcher thread. Selections, presses and releases are queued here instead
+ * and handled in order by the loader thread, so a release that comes in while a
+ * signal is still being staged is handled right after the press and TX can't be
+ * left on. Macro steps are sent here too, the macro timer only queues them. A
+ * step stops TX and waits for a streamed signal to finish before it is sent.
+ */
+
+#pragma once
+
+#include "ir_transmitter.h"
+#include "ir_macro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Called from the loader thread when a press started TX */
+typedef void (*LoaderStartCallback)(void* context);
+
+/** Called from the loader thread when TX a press started was stopped again */
+typedef void (*LoaderStopCallback)(void* context);
+
+typedef struct SignalLoader SignalLoader;
+
+/** Allocate a loader and start its thread
+ *
+ * @param      transmitter  Transmitter only used from the loader thread from now on
+ * @param      started      called when a press started TX
+ * @param      stopped      called when a release or unstage stopped it, not on free
+ * @param      context      context to pass to the callbacks
+ *
+ * @return     SignalLoader instance
+ */
+SignalLoader* loaderAlloc(
+    Transmitter* transmitter,
+    LoaderStartCallback started,
+    LoaderStopCallback stopped,
+    void* context);
+
+/** Stop TX, unstage and stop the thread
+ *
+ * @param      loader  SignalLoader instance
+ */
+void loaderFree(SignalLoader* loader);
+
+/** Queue staging a signal, for when its button gets focus
+ *
+ * Only the latest signal is staged when several are queued before the loader
+ * gets to them.
+ *
+ * @param      loader  SignalLoader instance
+ * @param      remote  remote holding the signal
+ * @param      index   signal to stage
+ */
+void loaderStage(SignalLoader* loader, const Remote* remote, uint32_t index);
+
+/** Queue starting TX of a signal
+ *
+ * @param      loader  SignalLoader instance
+ * @param      remote  remote holding the signal
+ * @param      index   signal to send
+ * @param      policy  how the signal repeats while held, copied
+ */
+void loaderPress(
+    SignalLoader* loader,
+    const Remote* remote,
+    uint32_t index,
+    const RepeatPolicy* policy);
+
+/** Queue stopping TX
+ *
+ * @param      loader  SignalLoader instance
+ */
+void loaderRelease(SignalLoader* loader);
+
+/** Queue sending the step of a macro that is due, without waiting
+ *
+ * Meant for the due callback of the runner, see MacroDueCallback. The runner
+ * has to outlive the loader or be stopped before it is freed.
+ *
+ * @param      loader  SignalLoader instance
+ * @param      runner  MacroRunner whose step is due
+ *
+ * @return     false if the queue was full
+ */
+bool loaderMacroStep(SignalLoader* loader, MacroRunner* runner);
+
+/** Stop TX and drop the staged signal, waiting until it is done
+ *
+ * Has to be called before the remote of the staged signal is loaded again or
+ * freed.
+ *
+ * @param      loader  SignalLoader instance
+ */
+void loaderUnstage(SignalLoader* loader);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,98 @@
+#include "ir_macro.h"
+
+struct MacroRunner {
+    FuriTimer* timer;
+    //held while sending, so stopping waits for a send that already started
+    FuriMutex* mutex;
+    MacroDueCallback due;
+    MacroSendCallback send;
+    void* context;
+    const MacroStep* steps;
+    size_t count;
+    //step being sent and how many times it was sent so far
+    size_t step;
+    uint16_t sent;
+    bool running;
+    //set by the timer, taken by macroStep, so a step handed over twice is sent once
+    bool stepDue;
+};
+
+uint32_t macroAdvance(MacroRunner* runner) {
+    while(runner->step < runner->count && !runner->steps[runner->step].repeat) {
+        runner->step++;
+    }
+    if(runner->step == runner->count) {
+        return MACRO_DONE;
+    }
+    const MacroStep* step = &runner->steps[runner->step];
+    runner->send(runner->context, step->signal);
+    if(++runner->sent == step->repeat) {
+        runner->sent = 0;
+        runner->step++;
+        if(runner->step == runner->count) {
+            return MACRO_DONE;
+        }
+    }
+    return step->gap;
+}
+//only hands the step over, the mutex is held while sending
+void macroTimerCallback(void* context) {
+    MacroRunner* runner = context;
+    __atomic_store_n(&runner->stepDue, true, __ATOMIC_RELEASE);
+    if(!runner->due(runner->context)) {
+        furi_timer_start(runner->timer, 1);
+    }
+}
+void macroStep(MacroRunner* runner) {
+    furi_mutex_acquire(runner->mutex, FuriWaitForever);
+    if(runner->running && __atomic_exchange_n(&runner->stepDue, false, __ATOMIC_ACQUIRE)) {
+        uint32_t gap = macroAdvance(runner);
+        if(gap == MACRO_DONE) {
+            runner->running = false;
+        } else {
+            //the gap is counted from the end of the send, the next tick at the soonest
+            furi_timer_start(runner->timer, MAX(furi_ms_to_ticks(gap), 1U));
+        }
+    }
+    furi_mutex_release(runner->mutex);
+}
+MacroRunner* macroRunnerAlloc(MacroDueCallback due, MacroSendCallback send, void* context) {
+    MacroRunner* runner = malloc(sizeof(MacroRunner));
+    runner->timer = furi_timer_alloc(macroTimerCallback, FuriTimerTypeOnce, runner);
+    runner->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    runner->due = due;
+    runner->send = send;
+    runner->context = context;
+    runner->steps = NULL;
+    runner->count = 0;
+    runner->step = 0;
+    runner->sent = 0;
+    runner->running = false;
+    runner->stepDue = false;
+    return runner;
+}
+void macroRunnerFree(MacroRunner* runner) {
+    macroStop(runner);
+    furi_timer_free(runner->timer);
+    furi_mutex_free(runner->mutex);
+    free(runner);
+}
+void macroStart(MacroRunner* runner, const MacroStep* steps, size_t count) {
+    macroStop(runner);
+    furi_mutex_acquire(runner->mutex, FuriWaitForever);
+    runner->steps = steps;
+    runner->count = count;
+    runner->step = 0;
+    runner->sent = 0;
+    runner->running = true;
+    runner->stepDue = false;
+    furi_mutex_release(runner->mutex);
+    furi_timer_start(runner->timer, 1);
+}
+void macroStop(MacroRunner* runner) {
+    furi_mutex_acquire(runner->mutex, FuriWaitForever);
+    runner->running = false;
+    furi_timer_stop(runner->timer);
+    __atomic_store_n(&runner->stepDue, false, __ATOMIC_RELAXED);
+    furi_mutex_release(runner->mutex);
+}
@@ -0,0 +1,97 @@
+/**
+ * @file ir_macro.h
+ * Runs a list of signals with gaps between them from one button
+ *
+ * Steps are timed by a one shot timer that is restarted after every send. The
+ * timer only tells the thread that sends that a step is due, which then calls
+ * macroStep, so neither the GUI nor the timer thread waits on a transmission.
+ * What a send does is up to the callback, the runner only decides what is sent
+ * when.
+ */
+
+#pragma once
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MACRO_DONE UINT32_MAX
+
+typedef struct {
+    //signal of the remote to send
+    uint32_t signal;
+    //how many times it is sent, gap is waited after every one of them
+    uint16_t repeat;
+    uint32_t gap;
+} MacroStep;
+
+/** A step is due, called from the timer thread
+ *
+ * Has to hand the step to a thread that calls macroStep and return right away.
+ *
+ * @return     false if it couldn't, it is asked again a tick later
+ */
+typedef bool (*MacroDueCallback)(void* context);
+
+/** Sends one frame of signal, called from macroStep */
+typedef void (*MacroSendCallback)(void* context, uint32_t signal);
+
+typedef struct MacroRunner MacroRunner;
+
+/** Allocate a runner
+ *
+ * @param      due      called when a step is due
+ * @param      send     called for every send
+ * @param      context  context to pass to the callbacks
+ *
+ * @return     MacroRunner instance
+ */
+MacroRunner* macroRunnerAlloc(MacroDueCallback due, MacroSendCallback send, void* context);
+
+/** Stop the running macro and free the runner
+ *
+ * @param      runner  MacroRunner instance
+ */
+void macroRunnerFree(MacroRunner* runner);
+
+/** Start a macro, stopping the one that is running
+ *
+ * steps have to stay valid until the macro is done or stopped.
+ *
+ * @param      runner  MacroRunner instance
+ * @param      steps   steps to run in order
+ * @param      count   number of steps
+ */
+void macroStart(MacroRunner* runner, const MacroStep* steps, size_t count);
+
+/** Stop the running macro, a send that already started is finished first
+ *
+ * @param      runner  MacroRunner instance
+ */
+void macroStop(MacroRunner* runner);
+
+/** Send the step that is due and start the timer for the next one
+ *
+ * Called on the thread the due callback handed the step to. Does nothing when no
+ * step is due, like after macroStop.
+ *
+ * @param      runner  MacroRunner instance
+ */
+void macroStep(MacroRunner* runner);
+
+/** Send the next frame of a macro
+ *
+ * This is what macroStep runs, it is exposed so the schedule can be stepped
+ * without a timer.
+ *
+ * @param      runner  MacroRunner instance
+ *
+ * @return     milliseconds until the next send, MACRO_DONE after the last one
+ */
+uint32_t macroAdvance(MacroRunner* runner);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,721 @@
+#include "ir_remote.h"
+
+#include <flipper_format_i.h>
+
+#include "latency_probe.h"
+
+#define TAG "FancyRemote"
+
+//bytes of a line read at a time when looking for the timings of a streamed signal
+#define RAW_SEEK_CHUNK 64
+
+/*raw timings are kept in 16 bits, values from 32768us up have the top bit set and
+are stored in 128us steps, which only costs precision on the long gaps between frames*/
+#define TIMING_LONG_FLAG 0x8000
+#define TIMING_LONG_SHIFT 7
+
+uint16_t packTiming(uint32_t timing) {
+    if(timing < TIMING_LONG_FLAG) {
+        return timing;
+    }
+    timing >>= TIMING_LONG_SHIFT;
+    return TIMING_LONG_FLAG | (timing < TIMING_LONG_FLAG ? timing : TIMING_LONG_FLAG - 1);
+}
+uint32_t unpackTiming(uint16_t timing) {
+    if(timing & TIMING_LONG_FLAG) {
+        return (uint32_t)(timing & ~TIMING_LONG_FLAG) << TIMING_LONG_SHIFT;
+    }
+    return timing;
+}
+#define ARENA_ALIGN(size) (((size) + 7) & ~(size_t)7)
+//empties the arena and makes sure it can hold size bytes, the heap is only touched to grow it
+void arenaReset(Arena* arena, size_t size) {
+    size = ARENA_ALIGN(size);
+    if(arena->size < size) {
+        free(arena->base);
+        arena->base = malloc(size);
+        arena->size = size;
+    }
+    arena->used = 0;
+}
+void* arenaAlloc(Arena* arena, size_t size) {
+    size = ARENA_ALIGN(size);
+    furi_check(arena->size - arena->used >= size);
+    void* out = arena->base + arena->used;
+    arena->used += size;
+    if(arena->used > arena->highWater) {
+        arena->highWater = arena->used;
+    }
+    return out;
+}
+void arenaFree(Arena* arena) {
+    free(arena->base);
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
+//arena bytes of a raw signal kept as a dictionary and its codes
+#define DICT_BYTES(dictSize, size) \
+    (ARENA_ALIGN(sizeof(uint16_t) * (dictSize)) + ARENA_ALIGN(((size) + 1) / 2))
+
+/*groups timings whose middle is within RAW_DICT_TOLERANCE of each of them, so the middle
+can stand in for all. ranges gets the lowest and highest timing of every group, 0 is
+returned when they need more than RAW_DICT_MAX groups*/
+uint32_t groupTimings(const uint32_t* timings, uint32_t size, uint32_t ranges[][2]) {
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < size; i++) {
+        uint32_t timing = timings[i];
+        uint32_t group = 0;
+        for(; group < count; group++) {
+            uint64_t low = MIN(ranges[group][0], timing);
+            uint64_t high = MAX(ranges[group][1], timing);
+            if(high * 100 <= low * (100 + 2 * RAW_DICT_TOLERANCE)) {
+                ranges[group][0] = low;
+                ranges[group][1] = high;
+                break;
+            }
+        }
+        if(group == count) {
+            if(count == RAW_DICT_MAX) {
+                return 0;
+            }
+            ranges[count][0] = timing;
+            ranges[count][1] = timing;
+            count++;
+        }
+    }
+    return count;
+}
+/*keeps size timings as a dictionary and a 4 bit index per timing, false when they don't
+fit a dictionary or it wouldn't be smaller than packing every timing*/
+bool makeDictionary(RawSignal* raw, const uint32_t* timings, uint32_t size, Arena* arena) {
+    uint32_t ranges[RAW_DICT_MAX][2];
+    uint32_t count = groupTimings(timings, size, ranges);
+    if(!count || DICT_BYTES(count, size) >= ARENA_ALIGN(sizeof(uint16_t) * size)) {
+        return false;
+    }
+    raw->data = arenaAlloc(arena, sizeof(uint16_t) * count);
+    for(uint32_t group = 0; group < count; group++) {
+        uint32_t low = ranges[group][0];
+        raw->data[group] = packTiming(low + (ranges[group][1] - low) / 2);
+    }
+    raw->codes = arenaAlloc(arena, (size + 1) / 2);
+    memset(raw->codes, 0, (size + 1) / 2);
+    for(uint32_t i = 0; i < size; i++) {
+        //the groups can overlap, any that holds the timing is close enough
+        uint32_t group = 0;
+        while(timings[i] < ranges[group][0] || timings[i] > ranges[group][1]) {
+            group++;
+        }
+        raw->codes[i / 2] |= group << (i % 2 * 4);
+    }
+    raw->dictSize = count;
+    return true;
+}
+void expandRawSignal(const RawSignal* raw, uint32_t* timings) {
+    if(!raw->codes) {
+        for(uint32_t i = 0; i < raw->size; i++) {
+            timings[i] = unpackTiming(raw->data[i]);
+        }
+        return;
+    }
+    uint32_t dict[RAW_DICT_MAX];
+    for(uint32_t group = 0; group < raw->dictSize; group++) {
+        dict[group] = unpackTiming(raw->data[group]);
+    }
+    for(uint32_t i = 0; i < raw->size; i++) {
+        timings[i] = dict[(raw->codes[i / 2] >> (i % 2 * 4)) & 0xF];
+    }
+}
+bool makeParsedBody(Signal* signal, FlipperFormat* ff) {
+    FuriString* tmp = furi_string_alloc();
+    bool out = true;
+    if(!flipper_format_read_string(ff, "protocol", tmp)) {
+        out = false;
+    }
+    InfraredMessage message;
+    message.protocol = infrared_get_protocol_by_name(furi_string_get_cstr(tmp));
+    furi_string_free(tmp);
+
+    if(!flipper_format_read_hex(ff, "address", (uint8_t*)&message.address, 4)) {
+        out = false;
+    }
+    if(!flipper_format_read_hex(ff, "command", (uint8_t*)&message.command, 4)) {
+        out = false;
+    }
+    message.repeat = true;
+
+    signal->isRaw = false;
+    signal->message = *&message;
+
+    return out;
+}
+/*offset of the timings of the next data: line from the stream position on. lines are
+read in chunks of RAW_SEEK_CHUNK bytes and only their start is kept, so a capture of any
+length takes no more memory to find*/
+bool findRawData(Stream* stream, size_t* offset) {
+    char chunk[RAW_SEEK_CHUNK];
+    const size_t keySize = strlen("data:");
+    while(true) {
+        size_t lineStart = stream_tell(stream);
+        size_t count = stream_read(stream, (uint8_t*)chunk, sizeof(chunk));
+        if(count >= keySize && memcmp(chunk, "data:", keySize) == 0) {
+            *offset = lineStart + keySize;
+            return true;
+        }
+        //anything else is skipped up to the next line
+        const char* end = memchr(chunk, '\n', count);
+        while(count && !end) {
+            count = stream_read(stream, (uint8_t*)chunk, sizeof(chunk));
+            end = memchr(chunk, '\n', count);
+        }
+        if(!end) {
+            return false;
+        }
+        size_t next = stream_tell(stream) - count + (end - chunk) + 1;
+        if(!stream_seek(stream, next, StreamOffsetFromStart)) {
+            return false;
+        }
+    }
+}
+//scratch has to hold size timings, they are read there and packed into the arena
+bool makeRawBody(Signal* signal, FlipperFormat* ff, Arena* arena, uint32_t* scratch) {
+    uint32_t frequency;
+    if(!flipper_format_read_uint32(ff, "frequency", &frequency, 1)) {
+        return false;
+    }
+    float duty_cycle;
+    if(!flipper_format_read_float(ff, "duty_cycle", &duty_cycle, 1)) {
+        return false;
+    }
+    uint32_t size;
+    if(!flipper_format_get_value_count(ff, "data", &size)) {
+        return false;
+    }
+    if(size > RAW_MAX_TIMINGS) {
+        //only remember where the timings are, they are streamed from the file when sent
+        size_t dataOffset;
+        if(!findRawData(flipper_format_get_raw_stream(ff), &dataOffset)) {
+            return false;
+        }
+        signal->isRaw = true;
+        signal->isStreamed = true;
+        signal->raw.data = NULL;
+        signal->raw.codes = NULL;
+        signal->raw.size = size;
+        signal->raw.frequency = frequency;
+        signal->raw.duty_cycle = duty_cycle;
+        signal->raw.dataOffset = dataOffset;
+        return true;
+    }
+    //a failed read just leaves the signal invalid
+    if(!flipper_format_read_uint32(ff, "data", scratch, size)) {
+        return false;
+    }
+    signal->raw.codes = NULL;
+    if(!makeDictionary(&signal->raw, scratch, size, arena)) {
+        uint16_t* data = arenaAlloc(arena, sizeof(uint16_t) * size);
+        for(uint32_t i = 0; i < size; i++) {
+            data[i] = packTiming(scratch[i]);
+        }
+        signal->raw.data = data;
+    }
+    signal->isRaw = true;
+    signal->raw.size = size;
+    signal->raw.frequency = frequency;
+    signal->raw.duty_cycle = duty_cycle;
+    return true;
+}
+bool makeBody(Signal* signal, FlipperFormat* ff, Arena* arena, uint32_t* scratch) {
+    FuriString* tmp = furi_string_alloc();
+    if(!flipper_format_read_string(ff, "type", tmp)) {
+        furi_string_free(tmp);
+        return false;
+    }
+    bool out = false;
+    if(furi_string_equal_str(tmp, "parsed")) {
+        out = makeParsedBody(signal, ff);
+    } else if(furi_string_equal_str(tmp, "raw")) {
+        out = makeRawBody(signal, ff, arena, scratch);
+    }
+    furi_string_free(tmp);
+    return out;
+}
+//number of timings the raw entry at the current position has, 0 for anything else
+uint32_t measureBody(FlipperFormat* ff) {
+    FuriString* tmp = furi_string_alloc();
+    uint32_t size = 0;
+    if(flipper_format_read_string(ff, "type", tmp) && furi_string_equal_str(tmp, "raw")) {
+        if(!flipper_format_get_value_count(ff, "data", &size)) {
+            size = 0;
+        }
+    }
+    furi_string_free(tmp);
+    return size;
+}
+/*starts a new remote with an empty Signal table, a buffer of scratch full width timings
+plus one for the repeat gap for sending raw signals and room for extra bytes of packed
+timings*/
+void startSignals(Remote* remote, size_t extra, uint32_t scratch) {
+    size_t table = ARENA_ALIGN(sizeof(Signal) * remote->count);
+    size_t timings = scratch ? ARENA_ALIGN(sizeof(uint32_t) * (scratch + 1)) : 0;
+    arenaReset(&remote->arena, table + timings + extra);
+    remote->signals = arenaAlloc(&remote->arena, table);
+    memset(remote->signals, 0, table);
+    remote->scratch = scratch ? arenaAlloc(&remote->arena, timings) : NULL;
+}
+uint32_t hashName(const char* name) {
+    //FNV-1a
+    uint32_t hash = 2166136261u;
+    while(*name) {
+        hash ^= (uint8_t)*name++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+void clearIndex(IrIndex* index) {
+    free(index->entries);
+    index->entries = NULL;
+    index->count = 0;
+    index->capacity = 0;
+    free(index->names);
+    index->names = NULL;
+    index->namesSize = 0;
+    index->namesCapacity = 0;
+    furi_string_reset(index->path);
+    index->size = 0;
+    index->timestamp = 0;
+}
+//copies name into the name pool of the index, returns where it starts
+uint32_t addIndexName(IrIndex* index, const FuriString* name) {
+    size_t size = furi_string_size(name) + 1;
+    if(index->namesSize + size > index->namesCapacity) {
+        while(index->namesSize + size > index->namesCapacity) {
+            index->namesCapacity = index->namesCapacity ? index->namesCapacity * 2 : 256;
+        }
+        index->names = realloc(index->names, index->namesCapacity);
+    }
+    uint32_t start = index->namesSize;
+    memcpy(index->names + start, furi_string_get_cstr(name), size);
+    index->namesSize += size;
+    return start;
+}
+/*one streaming pass over the file recording where every entry starts,
+kept until a different file is opened*/
+void buildIndex(IrIndex* index, FlipperFormat* ff, FuriString* path) {
+    clearIndex(index);
+    furi_string_set(index->path, path);
+    Stream* stream = flipper_format_get_raw_stream(ff);
+    FuriString* tmp = furi_string_alloc();
+    flipper_format_rewind(ff);
+    while(flipper_format_read_string(ff, "name", tmp)) {
+        if(index->count == index->capacity) {
+            index->capacity = index->capacity ? index->capacity * 2 : 16;
+            index->entries = realloc(index->entries, sizeof(IrIndexEntry) * index->capacity);
+        }
+        IrIndexEntry* entry = &index->entries[index->count++];
+        entry->hash = hashName(furi_string_get_cstr(tmp));
+        entry->offset = stream_tell(stream);
+        entry->name = addIndexName(index, tmp);
+    }
+    furi_string_free(tmp);
+}
+#define NO_ENTRY UINT32_MAX
+
+typedef struct {
+    uint32_t hash;
+    const char* name;
+    //NO_ENTRY for empty slots of the table
+    uint32_t button;
+    bool isAlias;
+} NameSlot;
+
+//slot of name in the table, or the empty slot where it would go
+size_t findNameSlot(const NameSlot* table, size_t size, uint32_t hash, const char* name) {
+    size_t at = hash & (size - 1);
+    while(table[at].button != NO_ENTRY &&
+          (table[at].hash != hash || strcmp(table[at].name, name) != 0)) {
+        at = (at + 1) & (size - 1);
+    }
+    return at;
+}
+
+/*finds the offset of the entry every button is filled from with one pass over the
+index. names and aliases go into an open addressing table keyed by their hash, then
+every entry is looked up once, a matching hash is only taken when the name matches too.
+names win over aliases, otherwise the first entry wins*/
+void resolveEntries(const IrIndex* index, const SignalNames* names, uint32_t* offsets) {
+    size_t total = names->count + names->aliasCount;
+    size_t size = 16;
+    while(size < total * 2) {
+        size *= 2;
+    }
+    NameSlot* table = malloc(sizeof(NameSlot) * size);
+    for(size_t i = 0; i < size; i++) {
+        table[i].button = NO_ENTRY;
+    }
+    for(size_t i = 0; i < total; i++) {
+        bool isAlias = i >= names->count;
+        const char* name = isAlias ? names->aliases[i - names->count].name : names->names[i];
+        uint32_t button = isAlias ? names->aliases[i - names->count].button : i;
+        if(button >= names->count) {
+            continue;
+        }
+        uint32_t hash = hashName(name);
+        size_t at = findNameSlot(table, size, hash, name);
+        //a name that is already in the table keeps its first button
+        if(table[at].button == NO_ENTRY) {
+            table[at].hash = hash;
+            table[at].name = name;
+            table[at].button = button;
+            table[at].isAlias = isAlias;
+        } else if(table[at].button != button) {
+            FURI_LOG_W(
+                TAG,
+                "%s %s already fills button %lu, ignored for button %lu",
+                isAlias ? "alias" : "name",
+                name,
+                table[at].button,
+                button);
+        }
+    }
+
+    bool* fromAlias = malloc(sizeof(bool) * names->count);
+    for(size_t i = 0; i < names->count; i++) {
+        offsets[i] = NO_ENTRY;
+        fromAlias[i] = false;
+    }
+    for(size_t i = 0; i < index->count; i++) {
+        const IrIndexEntry* entry = &index->entries[i];
+        const NameSlot* slot =
+            &table[findNameSlot(table, size, entry->hash, index->names + entry->name)];
+        if(slot->button == NO_ENTRY) {
+            continue;
+        }
+        if(offsets[slot->button] == NO_ENTRY || (fromAlias[slot->button] && !slot->isAlias)) {
+            offsets[slot->button] = entry->offset;
+            fromAlias[slot->button] = slot->isAlias;
+        }
+    }
+    free(fromAlias);
+    free(table);
+}
+/*compiled sidecar cache, <remote>.ir.fancycache
+header: magic, version, source size, source timestamp, hash of the names, payload size,
+scratch timings
+then for every name: flags (isValid, isRaw, isStreamed, has codes) and either
+protocol/address/command, frequency/duty_cycle/size/data[size], for signals with
+codes frequency/duty_cycle/size/dictSize/data[dictSize]/codes or for streamed
+signals frequency/duty_cycle/size/dataOffset. everything is little endian 32 bit
+words apart from data, which holds packed 16 bit timings, and codes, which holds
+4 bit indices, each padded to 8 bytes*/
+#define CACHE_EXTENSION ".fancycache"
+#define CACHE_MAGIC 0x31435246 //"FRC1"
+#define CACHE_VERSION 8
+#define CACHE_HEADER_SIZE (7 * sizeof(uint32_t))
+
+typedef struct {
+    uint32_t size;
+    uint32_t timestamp;
+    //the slots are in the order of the names, so a different list or aliases need a new cache
+    uint32_t names;
+} CacheKey;
+
+void putWord(uint8_t** cursor, uint32_t value) {
+    memcpy(*cursor, &value, sizeof(uint32_t));
+    *cursor += sizeof(uint32_t);
+}
+bool takeWord(const uint8_t** cursor, const uint8_t* end, uint32_t* value) {
+    if((size_t)(end - *cursor) < sizeof(uint32_t)) {
+        return false;
+    }
+    memcpy(value, *cursor, sizeof(uint32_t));
+    *cursor += sizeof(uint32_t);
+    return true;
+}
+bool getCacheKey(
+    Storage* storage,
+    const char* path,
+    const SignalNames* names,
+    CacheKey* key) {
+    FileInfo info;
+    if(storage_common_stat(storage, path, &info) != FSE_OK) {
+        return false;
+    }
+    key->size = info.size;
+    if(storage_common_timestamp(storage, path, &key->timestamp) != FSE_OK) {
+        key->timestamp = 0;
+    }
+    key->names = names->count;
+    for(size_t i = 0; i < names->count; i++) {
+        key->names = key->names * 31 + hashName(names->names[i]);
+    }
+    for(size_t i = 0; i < names->aliasCount; i++) {
+        key->names = key->names * 31 + hashName(names->aliases[i].name);
+        key->names = key->names * 31 + names->aliases[i].button;
+    }
+    return true;
+}
+/*timings are left in place inside the payload, which lives in the arena. scratch is the
+number of timings the scratch buffer holds, every raw signal has to fit*/
+bool decodeCache(Remote* remote, const uint8_t* cursor, const uint8_t* end, uint32_t scratch) {
+    for(size_t i = 0; i < remote->count; i++) {
+        Signal* signal = &remote->signals[i];
+        uint32_t flags;
+        if(!takeWord(&cursor, end, &flags)) {
+            return false;
+        }
+        signal->isValid = flags & 1;
+        if(flags & 2) {
+            uint32_t frequency, duty_cycle, size;
+            if(!takeWord(&cursor, end, &frequency) || !takeWord(&cursor, end, &duty_cycle) ||
+               !takeWord(&cursor, end, &size)) {
+                return false;
+            }
+            signal->isRaw = true;
+            signal->raw.frequency = frequency;
+            memcpy(&signal->raw.duty_cycle, &duty_cycle, sizeof(float));
+            signal->raw.size = size;
+            if(flags & 4) {
+                //streamed signals are queued for sending in the scratch
+                if(!remote->scratch || scratch < RAW_STREAM_CHUNK ||
+                   !takeWord(&cursor, end, &signal->raw.dataOffset)) {
+                    return false;
+                }
+                signal->isStreamed = true;
+                signal->raw.data = NULL;
+                signal->raw.codes = NULL;
+            } else if(size > RAW_MAX_TIMINGS || size > scratch) {
+                return false;
+            } else if(flags & 8) {
+                uint32_t dictSize;
+                if(!takeWord(&cursor, end, &dictSize) || !dictSize ||
+                   dictSize > RAW_DICT_MAX ||
+                   (size_t)(end - cursor) < DICT_BYTES(dictSize, size)) {
+                    return false;
+                }
+                signal->raw.data = (uint16_t*)cursor;
+                signal->raw.codes = (uint8_t*)cursor + ARENA_ALIGN(sizeof(uint16_t) * dictSize);
+                signal->raw.dictSize = dictSize;
+                cursor += DICT_BYTES(dictSize, size);
+                //every index has to point into the dictionary
+                for(uint32_t i = 0; i < size; i++) {
+                    if(((signal->raw.codes[i / 2] >> (i % 2 * 4)) & 0xF) >= dictSize) {
+                        return false;
+                    }
+                }
+            } else {
+                size_t bytes = ARENA_ALIGN(sizeof(uint16_t) * size);
+                if((size_t)(end - cursor) < bytes) {
+                    return false;
+                }
+                signal->raw.data = (uint16_t*)cursor;
+                signal->raw.codes = NULL;
+                cursor += bytes;
+            }
+        } else {
+            uint32_t protocol;
+            if(!takeWord(&cursor, end, &protocol) ||
+               !takeWord(&cursor, end, &signal->message.address) ||
+               !takeWord(&cursor, end, &signal->message.command)) {
+                return false;
+            }
+            signal->isRaw = false;
+            signal->message.protocol = (InfraredProtocol)(int32_t)protocol;
+            signal->message.repeat = true;
+        }
+    }
+    return cursor == end;
+}
+//loads the whole sidecar straight into the arena, false if it is missing, stale or damaged
+bool readCache(Remote* remote, Storage* storage, const char* path, const CacheKey* key) {
+    File* file = storage_file_alloc(storage);
+    bool out = false;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        uint32_t header[CACHE_HEADER_SIZE / sizeof(uint32_t)];
+        size_t size = storage_file_size(file);
+        if(storage_file_read(file, header, CACHE_HEADER_SIZE) == CACHE_HEADER_SIZE &&
+           header[0] == CACHE_MAGIC && header[1] == CACHE_VERSION && header[2] == key->size &&
+           header[3] == key->timestamp && header[4] == key->names &&
+           header[5] == size - CACHE_HEADER_SIZE &&
+           header[6] <= MAX(RAW_MAX_TIMINGS, RAW_STREAM_CHUNK)) {
+            uint32_t payload = header[5];
+            startSignals(remote, payload, header[6]);
+            uint8_t* buffer = arenaAlloc(&remote->arena, payload);
+            if(storage_file_read(file, buffer, payload) == payload) {
+                out = decodeCache(remote, buffer, buffer + payload, header[6]);
+            }
+        }
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    return out;
+}
+void writeCache(Remote* remote, Storage* storage, const char* path, const CacheKey* key) {
+    size_t payload = 0;
+    uint32_t scratch = 0;
+    for(size_t i = 0; i < remote->count; i++) {
+        const Signal* signal = &remote->signals[i];
+        payload += sizeof(uint32_t) * 4;
+        if(signal->isStreamed) {
+            payload += sizeof(uint32_t);
+            scratch = MAX(scratch, (uint32_t)RAW_STREAM_CHUNK);
+        } else if(signal->isRaw && signal->raw.codes) {
+            payload += sizeof(uint32_t) + DICT_BYTES(signal->raw.dictSize, signal->raw.size);
+            scratch = MAX(scratch, signal->raw.size);
+        } else if(signal->isRaw) {
+            payload += ARENA_ALIGN(sizeof(uint16_t) * signal->raw.size);
+            scratch = MAX(scratch, signal->raw.size);
+        }
+    }
+    uint8_t* buffer = malloc(CACHE_HEADER_SIZE + payload);
+    uint8_t* cursor = buffer;
+    putWord(&cursor, CACHE_MAGIC);
+    putWord(&cursor, CACHE_VERSION);
+    putWord(&cursor, key->size);
+    putWord(&cursor, key->timestamp);
+    putWord(&cursor, key->names);
+    putWord(&cursor, payload);
+    putWord(&cursor, scratch);
+    for(size_t i = 0; i < remote->count; i++) {
+        const Signal* signal = &remote->signals[i];
+        bool hasCodes = signal->isRaw && !signal->isStreamed && signal->raw.codes;
+        putWord(
+            &cursor,
+            (signal->isValid ? 1 : 0) | (signal->isRaw ? 2 : 0) | (signal->isStreamed ? 4 : 0) |
+                (hasCodes ? 8 : 0));
+        if(signal->isRaw) {
+            uint32_t duty_cycle;
+            memcpy(&duty_cycle, &signal->raw.duty_cycle, sizeof(float));
+            putWord(&cursor, signal->raw.frequency);
+            putWord(&cursor, duty_cycle);
+            putWord(&cursor, signal->raw.size);
+            if(signal->isStreamed) {
+                putWord(&cursor, signal->raw.dataOffset);
+            } else if(hasCodes) {
+                size_t bytes = DICT_BYTES(signal->raw.dictSize, signal->raw.size);
+                putWord(&cursor, signal->raw.dictSize);
+                memset(cursor, 0, bytes);
+                memcpy(cursor, signal->raw.data, sizeof(uint16_t) * signal->raw.dictSize);
+                memcpy(
+                    cursor + ARENA_ALIGN(sizeof(uint16_t) * signal->raw.dictSize),
+                    signal->raw.codes,
+                    (signal->raw.size + 1) / 2);
+                cursor += bytes;
+            } else {
+                size_t bytes = ARENA_ALIGN(sizeof(uint16_t) * signal->raw.size);
+                memset(cursor, 0, bytes);
+                memcpy(cursor, signal->raw.data, sizeof(uint16_t) * signal->raw.size);
+                cursor += bytes;
+            }
+        } else {
+            putWord(&cursor, (uint32_t)signal->message.protocol);
+            putWord(&cursor, signal->message.address);
+            putWord(&cursor, signal->message.command);
+        }
+    }
+    File* file = storage_file_alloc(storage);
+    bool written = false;
+    if(storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        written = storage_file_write(file, buffer, cursor - buffer) == (size_t)(cursor - buffer);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    if(!written) {
+        storage_common_remove(storage, path);
+    }
+    free(buffer);
+}
+/*fills every button that has a matching entry, see resolveEntries for which one.
+the raw entries are measured first so the arena is sized once for the whole remote.
+key is the one of the .ir file, the index is rebuilt when the file changed*/
+void parseSignals(
+    Remote* remote,
+    Storage* storage,
+    const SignalNames* names,
+    const CacheKey* key) {
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
+    if(flipper_format_buffered_file_open_existing(ff, furi_string_get_cstr(remote->path))) {
+        LATENCY_MARK(LatencyTrackLoad, LatencyStageOpen);
+        IrIndex* index = &remote->index;
+        if(!furi_string_equal(index->path, remote->path) || index->size != key->size ||
+           index->timestamp != key->timestamp) {
+            buildIndex(index, ff, remote->path);
+            index->size = key->size;
+            index->timestamp = key->timestamp;
+        }
+        uint32_t* offsets = malloc(sizeof(uint32_t) * remote->count);
+        resolveEntries(&remote->index, names, offsets);
+        Stream* stream = flipper_format_get_raw_stream(ff);
+        LATENCY_MARK(LatencyTrackLoad, LatencyStageIndex);
+        size_t timings = 0;
+        uint32_t scratch = 0;
+        for(size_t i = 0; i < remote->count; i++) {
+            if(offsets[i] != NO_ENTRY &&
+               stream_seek(stream, offsets[i], StreamOffsetFromStart)) {
+                uint32_t size = measureBody(ff);
+                if(size > RAW_MAX_TIMINGS) {
+                    scratch = MAX(scratch, (uint32_t)RAW_STREAM_CHUNK);
+                } else {
+                    timings += ARENA_ALIGN(sizeof(uint16_t) * size);
+                    scratch = MAX(scratch, size);
+                }
+            }
+        }
+        startSignals(remote, timings, scratch);
+        for(size_t i = 0; i < remote->count; i++) {
+            if(offsets[i] != NO_ENTRY &&
+               stream_seek(stream, offsets[i], StreamOffsetFromStart)) {
+                Signal* signal = &remote->signals[i];
+                signal->isValid = makeBody(signal, ff, &remote->arena, remote->scratch);
+            }
+        }
+        free(offsets);
+        LATENCY_MARK(LatencyTrackLoad, LatencyStageParse);
+    } else {
+        startSignals(remote, 0, 0);
+    }
+    flipper_format_buffered_file_close(ff);
+    flipper_format_free(ff);
+}
+//uses the compiled sidecar while it matches the .ir file, otherwise parses and rebuilds it
+void loadSignals(Remote* remote, const SignalNames* names) {
+    LATENCY_BEGIN(LatencyTrackLoad);
+    remote->count = names->count;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    const char* path = furi_string_get_cstr(remote->path);
+    FuriString* cache_path = furi_string_alloc_printf("%s" CACHE_EXTENSION, path);
+    CacheKey key;
+    if(!getCacheKey(storage, path, names, &key)) {
+        startSignals(remote, 0, 0);
+    } else {
+        bool cached = readCache(remote, storage, furi_string_get_cstr(cache_path), &key);
+        LATENCY_MARK(LatencyTrackLoad, LatencyStageCache);
+        if(!cached) {
+            parseSignals(remote, storage, names, &key);
+            writeCache(remote, storage, furi_string_get_cstr(cache_path), &key);
+        }
+    }
+    furi_string_free(cache_path);
+    furi_record_close(RECORD_STORAGE);
+    FURI_LOG_D(
+        TAG,
+        "remote uses %zu of %zu arena bytes, high water %zu",
+        remote->arena.used,
+        remote->arena.size,
+        remote->arena.highWater);
+    LATENCY_END(LatencyTrackLoad);
+}
+void remoteInit(Remote* remote) {
+    memset(remote, 0, sizeof(Remote));
+    remote->path = furi_string_alloc();
+    remote->index.path = furi_string_alloc();
+}
+void remoteFree(Remote* remote) {
+    arenaFree(&remote->arena);
+    clearIndex(&remote->index);
+    furi_string_free(remote->index.path);
+    furi_string_free(remote->path);
+    remote->signals = NULL;
+    remote->scratch = NULL;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file ir_remote.h
+ * Signals of one .ir remote, preloaded for sending
+ *
+ * Looks up a fixed list of button names in a .ir file and keeps one Signal per
+ * name in a single arena. A compiled sidecar next to the .ir file is used in
+ * place of parsing it while the file is unchanged. Nothing here touches the
+ * GUI, the signals are sent by ir_transmitter.h.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <storage/storage.h>
+#include <flipper_format.h>
+#include <infrared.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//the infrared worker takes at most this many timings per signal
+#define RAW_MAX_TIMINGS 1024
+//streamed signals are queued for sending in a ring of this many timings, a power of 2
+#define RAW_STREAM_CHUNK 512
+/*a timing may be moved by up to this many percent to share a dictionary entry with
+similar ones, 0 keeps every timing exact*/
+#define RAW_DICT_TOLERANCE 4
+//most dictionary entries of a signal, so an index fits in 4 bits
+#define RAW_DICT_MAX 16
+
+typedef struct {
+    uint32_t frequency;
+    float duty_cycle;
+    /*packed with packTiming, expanded into the worker's buffer only when sent. when codes
+    is set this is the dictionary instead, with dictSize entries*/
+    uint16_t* data;
+    //a 4 bit dictionary index per timing, two to a byte, NULL when data holds every timing
+    uint8_t* codes;
+    uint32_t dictSize;
+    uint32_t size;
+    //where the data: values start in the .ir file, only used by streamed signals
+    uint32_t dataOffset;
+} RawSignal;
+
+typedef struct {
+    bool isValid;
+    bool isRaw;
+    //too long to keep in memory, data is NULL and timings are read from the file while sending
+    bool isStreamed;
+    InfraredMessage message;
+    RawSignal raw;
+} Signal;
+
+//byte offset of the body that follows each name: line, in file order
+typedef struct {
+    uint32_t hash;
+    uint32_t offset;
+    //where the name starts in IrIndex.names, the hash only picks candidates
+    uint32_t name;
+} IrIndexEntry;
+
+typedef struct {
+    /*file the index was built from, with its size and timestamp then. a changed file at
+    the same path has its entries somewhere else*/
+    FuriString* path;
+    uint32_t size;
+    uint32_t timestamp;
+    IrIndexEntry* entries;
+    size_t count;
+    size_t capacity;
+    //every name, each ending in a '\0'
+    char* names;
+    size_t namesSize;
+    size_t namesCapacity;
+} IrIndex;
+
+/*one block sized when a remote is loaded that holds its Signal table and every
+timing array, it is only reallocated when a bigger remote comes along*/
+typedef struct {
+    uint8_t* base;
+    size_t size;
+    size_t used;
+    //most bytes ever handed out, for debugging how big remotes really get
+    size_t highWater;
+} Arena;
+
+//another .ir entry name that can fill the signal of button
+typedef struct {
+    const char* name;
+    uint32_t button;
+} SignalAlias;
+
+//which .ir entries fill the signals of a remote
+typedef struct {
+    //names[i] fills signal i
+    const char* const* names;
+    size_t count;
+    //only used for signals whose own name isn't in the file
+    const SignalAlias* aliases;
+    size_t aliasCount;
+} SignalNames;
+
+typedef struct {
+    //the .ir file, set before calling loadSignals
+    FuriString* path;
+    //one preloaded signal per name living in arena, filled once by loadSignals
+    Signal* signals;
+    size_t count;
+    /*full width timings for the transmitter, from the arena and big enough for the
+    longest in memory signal of the remote or the ring of a streamed one, plus one*/
+    uint32_t* scratch;
+    Arena arena;
+    IrIndex index;
+} Remote;
+
+/** Pack a raw timing into 16 bits, values from 32768us up lose precision
+ *
+ * @param      timing  timing in microseconds
+ *
+ * @return     packed timing
+ */
+uint16_t packTiming(uint32_t timing);
+
+/** Expand a timing packed by packTiming()
+ *
+ * @param      timing  packed timing
+ *
+ * @return     timing in microseconds
+ */
+uint32_t unpackTiming(uint16_t timing);
+
+/** Expand the timings of a raw signal that is kept in memory
+ *
+ * @param      raw      the signal, not a streamed one
+ * @param      timings  filled with raw->size timings in microseconds
+ */
+void expandRawSignal(const RawSignal* raw, uint32_t* timings);
+
+/** Initialize an empty remote
+ *
+ * @param      remote  Remote instance
+ */
+void remoteInit(Remote* remote);
+
+/** Free everything the remote holds
+ *
+ * @param      remote  Remote instance
+ */
+void remoteFree(Remote* remote);
+
+/** Load signals for a list of button names from remote->path
+ *
+ * Signals[i] is filled from the first entry called names[i], or failing that from
+ * the first entry called by one of its aliases. Signals without a matching entry
+ * are left invalid. Uses the sidecar cache when it matches.
+ *
+ * @param      remote  Remote instance
+ * @param      names   button names and aliases, looked up in the .ir file
+ */
+void loadSignals(Remote* remote, const SignalNames* names);
+
+#ifdef __cplusplus
+}
+#endif
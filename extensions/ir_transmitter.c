@@ -0,0 +1,348 @@
+#include "ir_transmitter.h"
+
+#include <flipper_format_i.h>
+#include <infrared_transmit.h>
+
+#include "latency_probe.h"
+
+#define TAG "FancyRemote"
+
+//next character of the streamed data: line, 0 once the line or the file ends
+char rawStreamChar(RawStream* rawStream) {
+    if(rawStream->textPos == rawStream->textLen) {
+        Stream* stream = flipper_format_get_raw_stream(rawStream->ff);
+        rawStream->textLen = stream_read(stream, rawStream->text, sizeof(rawStream->text));
+        rawStream->textPos = 0;
+        if(!rawStream->textLen) {
+            return 0;
+        }
+    }
+    char c = rawStream->text[rawStream->textPos++];
+    return c == '\n' ? 0 : c;
+}
+/*ring entries of streamed signals, the timing in microseconds and whether it is a mark,
+ends a pass or ends TX*/
+#define RAW_STREAM_TIMING 0x1FFFFFFFu
+#define RAW_STREAM_MARK (1u << 29)
+#define RAW_STREAM_PASS_END (1u << 30)
+#define RAW_STREAM_LAST (1u << 31)
+//space sent when the loader falls behind, so the interrupt never waits
+#define RAW_STREAM_UNDERRUN_US 1000
+
+void rawStreamPush(RawStream* rawStream, uint32_t entry) {
+    rawStream->timings[rawStream->head % RAW_STREAM_CHUNK] = entry;
+    __atomic_store_n(&rawStream->head, rawStream->head + 1, __ATOMIC_RELEASE);
+}
+void rawStreamRewind(RawStream* rawStream) {
+    stream_seek(
+        flipper_format_get_raw_stream(rawStream->ff),
+        rawStream->signal->raw.dataOffset,
+        StreamOffsetFromStart);
+    rawStream->textPos = 0;
+    rawStream->textLen = 0;
+    rawStream->read = 0;
+}
+/*queues timings parsed from the file until the ring is full. every pass ends in a space
+of at least RAW_STREAM_MIN_GAP, then the file is rewound for the next one unless it was
+the last. a malformed line ends the pass early*/
+void rawStreamFill(Transmitter* transmitter) {
+    RawStream* rawStream = &transmitter->rawStream;
+    uint32_t size = rawStream->signal->raw.size;
+    uint32_t gap = MAX(transmitter->policy.gap, RAW_STREAM_MIN_GAP) * 1000;
+    //room for a timing and the gap after it
+    while(!rawStream->queuedLast &&
+          rawStream->head - __atomic_load_n(&rawStream->tail, __ATOMIC_ACQUIRE) <=
+              RAW_STREAM_CHUNK - 2) {
+        char c = rawStreamChar(rawStream);
+        while(c == ' ' || c == '\r') {
+            c = rawStreamChar(rawStream);
+        }
+        bool valid = c >= '0' && c <= '9';
+        uint32_t value = 0;
+        while(c >= '0' && c <= '9') {
+            value = value * 10 + (c - '0');
+            c = rawStreamChar(rawStream);
+        }
+        bool mark = rawStream->read % 2 == 0;
+        if(valid) {
+            rawStream->read++;
+        }
+        value = MIN(value, RAW_STREAM_TIMING);
+        if(valid && rawStream->read < size) {
+            rawStreamPush(rawStream, value | (mark ? RAW_STREAM_MARK : 0));
+            continue;
+        }
+        //the end of a pass, the gap goes after a trailing mark or onto the last space
+        if(valid && mark) {
+            rawStreamPush(rawStream, value | RAW_STREAM_MARK);
+        } else if(valid) {
+            gap += value;
+        }
+        bool last = !rawStream->read ||
+                    __atomic_load_n(&rawStream->stopRequested, __ATOMIC_ACQUIRE) ||
+                    repeatNextFrame(&transmitter->policy, ++rawStream->passes) ==
+                        RepeatFrameStop;
+        uint32_t end = last ? RAW_STREAM_LAST : RAW_STREAM_PASS_END;
+        rawStreamPush(rawStream, MIN(gap, RAW_STREAM_TIMING) | end);
+        rawStream->queuedLast = last;
+        if(!last) {
+            rawStreamRewind(rawStream);
+        }
+    }
+}
+bool rawStreamOpen(Transmitter* transmitter, const Signal* signal) {
+    RawStream* rawStream = &transmitter->rawStream;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    rawStream->ff = flipper_format_buffered_file_alloc(storage);
+    if(!flipper_format_buffered_file_open_existing(
+           rawStream->ff, furi_string_get_cstr(transmitter->remote->path))) {
+        flipper_format_free(rawStream->ff);
+        rawStream->ff = NULL;
+        furi_record_close(RECORD_STORAGE);
+        return false;
+    }
+    rawStream->signal = signal;
+    rawStreamRewind(rawStream);
+    return true;
+}
+void rawStreamClose(Transmitter* transmitter) {
+    RawStream* rawStream = &transmitter->rawStream;
+    if(rawStream->ff) {
+        flipper_format_buffered_file_close(rawStream->ff);
+        flipper_format_free(rawStream->ff);
+        rawStream->ff = NULL;
+        furi_record_close(RECORD_STORAGE);
+    }
+}
+RepeatFrame repeatNextFrame(const RepeatPolicy* policy, uint32_t sent) {
+    if(policy->maxFrames && sent >= policy->maxFrames) {
+        return RepeatFrameStop;
+    }
+    return sent ? RepeatFrameRepeat : RepeatFrameFirst;
+}
+/*adds gap ms of silence to the end of count timings, as a space of its own after a
+trailing mark. timings has room for one more than the longest signal*/
+uint32_t appendGap(uint32_t* timings, uint32_t count, uint16_t gap) {
+    if(!gap || !count) {
+        return count;
+    }
+    if(count % 2) {
+        timings[count++] = gap * 1000;
+    } else {
+        timings[count - 1] += gap * 1000;
+    }
+    return count;
+}
+//expands a packed signal for the worker on the first call and repeats it after that
+InfraredWorkerGetSignalResponse rawSignalCallback(void* context, InfraredWorker* worker) {
+    Transmitter* transmitter = context;
+    RawStream* rawStream = &transmitter->rawStream;
+    const RawSignal* raw = &rawStream->signal->raw;
+    RepeatFrame frame = repeatNextFrame(&transmitter->policy, transmitter->frames++);
+    if(frame == RepeatFrameStop) {
+        return InfraredWorkerGetSignalResponseStop;
+    }
+    if(rawStream->read) {
+        return InfraredWorkerGetSignalResponseSame;
+    }
+    expandRawSignal(raw, rawStream->timings);
+    rawStream->read = raw->size;
+    uint32_t count = appendGap(rawStream->timings, raw->size, transmitter->policy.gap);
+    infrared_worker_set_raw_signal(
+        worker, rawStream->timings, count, raw->frequency, raw->duty_cycle);
+    return InfraredWorkerGetSignalResponseNew;
+}
+/*the worker's encoder sends the protocol's own repeat code after the first frame, at the
+period the protocol sets, so only the frame limit applies*/
+InfraredWorkerGetSignalResponse decodedSignalCallback(void* context, InfraredWorker* worker) {
+    UNUSED(worker);
+    Transmitter* transmitter = context;
+    switch(repeatNextFrame(&transmitter->policy, transmitter->frames++)) {
+    case RepeatFrameFirst:
+        return InfraredWorkerGetSignalResponseNew;
+    case RepeatFrameRepeat:
+        return InfraredWorkerGetSignalResponseSame;
+    default:
+        return InfraredWorkerGetSignalResponseStop;
+    }
+}
+/*hands the async TX hardware the next timing of a streamed signal, in interrupt context.
+TX ends after the last pass or after the pass that was being sent when the button was
+released*/
+FuriHalInfraredTxGetDataState
+    rawStreamIsrCallback(void* context, uint32_t* duration, bool* level) {
+    RawStream* rawStream = context;
+    if(rawStream->tail == __atomic_load_n(&rawStream->head, __ATOMIC_ACQUIRE)) {
+        rawStream->underruns++;
+        *duration = RAW_STREAM_UNDERRUN_US;
+        *level = false;
+        return FuriHalInfraredTxGetDataStateOk;
+    }
+    uint32_t entry = rawStream->timings[rawStream->tail % RAW_STREAM_CHUNK];
+    __atomic_store_n(&rawStream->tail, rawStream->tail + 1, __ATOMIC_RELEASE);
+    *duration = entry & RAW_STREAM_TIMING;
+    *level = entry & RAW_STREAM_MARK;
+    if((entry & RAW_STREAM_LAST) ||
+       ((entry & RAW_STREAM_PASS_END) &&
+        __atomic_load_n(&rawStream->stopRequested, __ATOMIC_ACQUIRE))) {
+        __atomic_store_n(&rawStream->done, true, __ATOMIC_RELEASE);
+        return FuriHalInfraredTxGetDataStateLastDone;
+    }
+    return (entry & RAW_STREAM_PASS_END) ? FuriHalInfraredTxGetDataStateDone :
+                                           FuriHalInfraredTxGetDataStateOk;
+}
+//makes the staged signal start from its beginning on the next tx_start
+void rearmSignal(Transmitter* transmitter) {
+    if(transmitter->remote->signals[transmitter->staged].isStreamed) {
+        rawStreamRewind(&transmitter->rawStream);
+    } else {
+        transmitter->rawStream.read = 0;
+    }
+    transmitter->frames = 0;
+}
+bool transmitterPoll(Transmitter* transmitter) {
+    RawStream* rawStream = &transmitter->rawStream;
+    if(!rawStream->active) {
+        return false;
+    }
+    if(!__atomic_load_n(&rawStream->done, __ATOMIC_ACQUIRE)) {
+        rawStreamFill(transmitter);
+        return true;
+    }
+    furi_hal_infrared_async_tx_wait_termination();
+    rawStream->active = false;
+    if(rawStream->underruns) {
+        FURI_LOG_W(TAG, "stream ran dry %lu times", rawStream->underruns);
+    }
+    rearmSignal(transmitter);
+    return false;
+}
+//stops a stream that is still going and waits for its last pass to be out
+void finishStream(Transmitter* transmitter) {
+    if(transmitter->rawStream.active) {
+        stopSignal(transmitter);
+        while(transmitterPoll(transmitter)) {
+            furi_delay_ms(RAW_STREAM_POLL_MS);
+        }
+    }
+}
+void unstageSignal(Transmitter* transmitter) {
+    finishStream(transmitter);
+    rawStreamClose(transmitter);
+    transmitter->staged = STAGED_NONE;
+}
+/*sets the worker up for a button ahead of its press, it stays that way until another
+button gets focus or the remote changes so pressing OK only has to start TX*/
+void stageSignal(Transmitter* transmitter, const Remote* remote, uint32_t index) {
+    unstageSignal(transmitter);
+    const Signal* signal =
+        remote->signals && index < remote->count ? &remote->signals[index] : NULL;
+    if(!signal || !signal->isValid) {
+        return;
+    }
+    //allocated on first use, so starting the app doesn't wait for it
+    if(!transmitter->worker) {
+        transmitter->worker = infrared_worker_alloc();
+    }
+    transmitter->remote = remote;
+    transmitter->rawStream.timings = remote->scratch;
+    transmitter->frames = 0;
+    if(signal->isStreamed) {
+        //sent by async TX, not the worker
+        if(!rawStreamOpen(transmitter, signal)) {
+            return;
+        }
+    } else if(signal->isRaw) {
+        transmitter->rawStream.signal = signal;
+        transmitter->rawStream.read = 0;
+        infrared_worker_tx_set_get_signal_callback(
+            transmitter->worker, rawSignalCallback, transmitter);
+    } else {
+        infrared_worker_tx_set_get_signal_callback(
+            transmitter->worker, decodedSignalCallback, transmitter);
+        const InfraredMessage message = signal->message;
+        infrared_worker_set_decoded_signal(transmitter->worker, &message);
+    }
+    transmitter->staged = index;
+}
+bool startSignal(
+    Transmitter* transmitter,
+    const Remote* remote,
+    uint32_t index,
+    const RepeatPolicy* policy) {
+    finishStream(transmitter);
+    if(transmitter->staged != index || transmitter->remote != remote) {
+        stageSignal(transmitter, remote, index);
+    }
+    LATENCY_MARK(LatencyTrackPress, LatencyStageStage);
+    if(transmitter->staged != index) {
+        return false;
+    }
+    //staged and rearmed signals are expanded on their first frame, with this gap
+    transmitter->policy = *policy;
+    const Signal* signal = &remote->signals[index];
+    if(signal->isStreamed) {
+        RawStream* rawStream = &transmitter->rawStream;
+        rawStream->head = 0;
+        rawStream->tail = 0;
+        rawStream->passes = 0;
+        rawStream->queuedLast = false;
+        rawStream->stopRequested = false;
+        rawStream->done = false;
+        rawStream->underruns = 0;
+        rawStreamFill(transmitter);
+        rawStream->active = true;
+        furi_hal_infrared_async_tx_set_data_isr_callback(rawStreamIsrCallback, rawStream);
+        furi_hal_infrared_async_tx_start(signal->raw.frequency, signal->raw.duty_cycle);
+    } else {
+        infrared_worker_tx_start(transmitter->worker);
+        transmitter->transmitting = true;
+    }
+    LATENCY_MARK(LatencyTrackPress, LatencyStageTxStart);
+    return true;
+}
+void stopSignal(Transmitter* transmitter) {
+    if(transmitter->rawStream.active) {
+        //the interrupt stops at the end of its pass, transmitterPoll finishes up after it
+        __atomic_store_n(&transmitter->rawStream.stopRequested, true, __ATOMIC_RELEASE);
+    }
+    if(transmitter->transmitting) {
+        infrared_worker_tx_stop(transmitter->worker);
+        transmitter->transmitting = false;
+        rearmSignal(transmitter);
+    }
+}
+void transmitterInit(Transmitter* transmitter) {
+    memset(transmitter, 0, sizeof(Transmitter));
+    transmitter->staged = STAGED_NONE;
+}
+void transmitterFree(Transmitter* transmitter) {
+    stopSignal(transmitter);
+    unstageSignal(transmitter);
+    if(transmitter->worker) {
+        infrared_worker_free(transmitter->worker);
+        transmitter->worker = NULL;
+    }
+}
+bool sendSignalOnce(const Remote* remote, uint32_t index) {
+    const Signal* signal =
+        remote->signals && index < remote->count ? &remote->signals[index] : NULL;
+    if(!signal || !signal->isValid || signal->isStreamed) {
+        return false;
+    }
+    if(signal->isRaw) {
+        expandRawSignal(&signal->raw, remote->scratch);
+        infrared_send_raw_ext(
+            remote->scratch,
+            signal->raw.size,
+            true,
+            signal->raw.frequency,
+            signal->raw.duty_cycle);
+    } else {
+        //the stored message is a repeat for the worker, a single send wants the full frame
+        InfraredMessage message = signal->message;
+        message.repeat = false;
+        infrared_send(&message, 1);
+    }
+    return true;
+}
@@ -0,0 +1,197 @@
+/**
+ * @file ir_transmitter.h
+ * Sends the signals of a Remote through the infrared worker
+ *
+ * A signal is staged when its button gets focus, so the worker is already set
+ * up for it and pressing OK only has to start TX. How a held button repeats is
+ * set per press by a RepeatPolicy, applied each time the worker asks for the next
+ * frame.
+ *
+ * Streamed signals don't fit the worker. Their timings are read from the file
+ * into a ring that the async TX interrupt empties, so a capture of any length
+ * goes out in one piece. The ring has to be topped up by transmitterPoll()
+ * while they are sent.
+ */
+
+#pragma once
+
+#include "ir_remote.h"
+
+#include <furi_hal_infrared.h>
+#include <infrared_worker.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STAGED_NONE UINT32_MAX
+
+/*how a held button repeats, all 0 keeps sending the signal back to back until it is
+released*/
+typedef struct {
+    //ms of silence added after every frame of raw signals
+    uint16_t gap;
+    //frames sent for one press including the first, 0 for no limit
+    uint16_t maxFrames;
+} RepeatPolicy;
+
+typedef enum {
+    RepeatFrameFirst,
+    RepeatFrameRepeat,
+    RepeatFrameStop,
+} RepeatFrame;
+
+//a streamed signal has to be topped up at least this often while it is sent
+#define RAW_STREAM_POLL_MS 10
+//ms of silence between two passes of a streamed signal when the policy sets less
+#define RAW_STREAM_MIN_GAP 40
+
+/*state of the raw signal currently being sent, see rawSignalCallback and
+rawStreamIsrCallback. ff is only open for streamed signals*/
+typedef struct {
+    FlipperFormat* ff;
+    const Signal* signal;
+    /*full width timings handed to the worker, this is the scratch buffer of the remote.
+    streamed signals use it as a ring of RAW_STREAM_CHUNK timings for the interrupt*/
+    uint32_t* timings;
+    //ring positions, head is only moved by the loader thread and tail by the interrupt
+    uint32_t head;
+    uint32_t tail;
+    //timings read from the file during this pass, and passes queued so far
+    uint32_t read;
+    uint32_t passes;
+    //the last pass is queued, TX stops after it
+    bool queuedLast;
+    //set on release, the interrupt stops at the end of the pass it is in
+    bool stopRequested;
+    //set by the interrupt once the last timing is out
+    bool done;
+    //async TX is on, until transmitterPoll sees it done
+    bool active;
+    //times the interrupt found the ring empty
+    uint32_t underruns;
+    //unparsed text left over from the last read
+    uint8_t text[32];
+    uint8_t textPos;
+    uint8_t textLen;
+} RawStream;
+
+typedef struct {
+    //NULL until the first signal is staged
+    InfraredWorker* worker;
+    //remote the staged signal belongs to
+    const Remote* remote;
+    RawStream rawStream;
+    //signal the worker is set up for, STAGED_NONE when there is none
+    uint32_t staged;
+    bool transmitting;
+    //policy of the press being sent and how many frames the worker asked for so far
+    RepeatPolicy policy;
+    uint32_t frames;
+} Transmitter;
+
+/** Decide which frame of a held button comes next
+ *
+ * Kept apart from the worker so the cadence can be checked without one.
+ *
+ * @param      policy  RepeatPolicy of the button
+ * @param      sent    frames already sent for this press
+ *
+ * @return     the frame to send, or RepeatFrameStop when the press is done
+ */
+RepeatFrame repeatNextFrame(const RepeatPolicy* policy, uint32_t sent);
+
+/** Start with nothing staged, the worker is allocated when a signal is first staged
+ *
+ * @param      transmitter  Transmitter instance
+ */
+void transmitterInit(Transmitter* transmitter);
+
+/** Stop sending and free the worker if there is one
+ *
+ * @param      transmitter  Transmitter instance
+ */
+void transmitterFree(Transmitter* transmitter);
+
+/** Set the worker up for a signal ahead of its press
+ *
+ * It stays staged until another signal is staged or unstageSignal() is called,
+ * which has to happen before the remote is loaded again or freed.
+ *
+ * @param      transmitter  Transmitter instance
+ * @param      remote       remote holding the signal
+ * @param      index        signal to stage, invalid signals leave nothing staged
+ */
+void stageSignal(Transmitter* transmitter, const Remote* remote, uint32_t index);
+
+/** Drop the staged signal and close its file if it is streamed
+ *
+ * @param      transmitter  Transmitter instance
+ */
+void unstageSignal(Transmitter* transmitter);
+
+/** Start sending a signal, staging it first when it isn't
+ *
+ * TX stops by itself after policy->maxFrames frames, stopSignal() still has to
+ * be called on release.
+ *
+ * @param      transmitter  Transmitter instance
+ * @param      remote       remote holding the signal
+ * @param      index        signal to send
+ * @param      policy       how the signal repeats while held
+ *
+ * @return     true if TX started
+ */
+bool startSignal(
+    Transmitter* transmitter,
+    const Remote* remote,
+    uint32_t index,
+    const RepeatPolicy* policy);
+
+/** Stop sending, the signal stays staged and starts from its beginning next time
+ *
+ * Streamed signals finish the pass they are in, transmitterPoll() has to be
+ * called until that is done.
+ *
+ * @param      transmitter  Transmitter instance
+ */
+void stopSignal(Transmitter* transmitter);
+
+/** Top up a streamed signal being sent and finish it once its last timing is out
+ *
+ * Staging, starting or unstaging another signal waits for a stream to finish,
+ * polling it in the meantime.
+ *
+ * @param      transmitter  Transmitter instance
+ *
+ * @return     true while a streamed signal is being sent, call again within
+ *             RAW_STREAM_POLL_MS
+ */
+bool transmitterPoll(Transmitter* transmitter);
+
+/** Stop a streamed signal being sent and wait until its last pass is out
+ *
+ * Polls it in the meantime. Afterwards async TX is idle and the scratch buffer
+ * of the remote is free again, see sendSignalOnce().
+ *
+ * @param      transmitter  Transmitter instance
+ */
+void finishStream(Transmitter* transmitter);
+
+/** Send one frame of a signal right away, without the worker
+ *
+ * Blocks until the frame is out. Nothing may be transmitting at the same time,
+ * and raw signals are expanded into the scratch buffer of the remote, which a
+ * streamed signal uses as its ring. Stop and finish the transmitter first.
+ * Streamed signals are too long for this and are skipped.
+ *
+ * @param      remote  remote holding the signal
+ * @param      index   signal to send
+ *
+ * @return     true if it was sent
+ */
+bool sendSignalOnce(const Remote* remote, uint32_t index);
+
+#ifdef __cplusplus
+}
+#endif
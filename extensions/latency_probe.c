@@ -0,0 +1,117 @@
+#include "latency_probe.h"
+
+#if LATENCY_PROBE_ENABLED
+
+#include <furi_hal.h>
+#include <storage/storage.h>
+
+#define LATENCY_PROBE_RING 64
+
+static const char* const latency_probe_stage_names[LatencyTrackCount][LatencyStageCount] = {
+    {"input", "process_ok", "stage", "tx_start"},
+    {"cache", "open", "index", "parse"},
+    {"init", "pick", "load", "first_frame"},
+};
+static const char* const latency_probe_track_names[LatencyTrackCount] = {
+    "press",
+    "load",
+    "startup"};
+
+typedef struct {
+    // cycle counter when the open record began and the last stage was marked
+    uint32_t start;
+    uint32_t last;
+    uint32_t current[LatencyStageCount];
+    bool open;
+    // cycles spent in every stage, for the last LATENCY_PROBE_RING records
+    uint32_t ring[LATENCY_PROBE_RING][LatencyStageCount];
+    size_t head;
+    size_t count;
+} LatencyProbeTrack;
+
+static LatencyProbeTrack latency_probe_tracks[LatencyTrackCount];
+
+void latency_probe_begin(LatencyTrack track) {
+    LatencyProbeTrack* probe = &latency_probe_tracks[track];
+    probe->start = DWT->CYCCNT;
+    probe->last = probe->start;
+    memset(probe->current, 0, sizeof(probe->current));
+    probe->open = true;
+}
+
+void latency_probe_mark(LatencyTrack track, LatencyStage stage) {
+    LatencyProbeTrack* probe = &latency_probe_tracks[track];
+    if(!probe->open) {
+        return;
+    }
+    uint32_t now = DWT->CYCCNT;
+    probe->current[stage] += now - probe->last;
+    probe->last = now;
+}
+
+void latency_probe_end(LatencyTrack track) {
+    LatencyProbeTrack* probe = &latency_probe_tracks[track];
+    if(!probe->open) {
+        return;
+    }
+    memcpy(probe->ring[probe->head], probe->current, sizeof(probe->current));
+    probe->head = (probe->head + 1) % LATENCY_PROBE_RING;
+    if(probe->count < LATENCY_PROBE_RING) {
+        probe->count++;
+    }
+    probe->open = false;
+}
+
+static int latency_probe_compare(const void* a, const void* b) {
+    uint32_t left = *(const uint32_t*)a;
+    uint32_t right = *(const uint32_t*)b;
+    return (left > right) - (left < right);
+}
+
+void latency_probe_dump(void) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    FuriString* line = furi_string_alloc();
+    const uint32_t per_us = furi_hal_cortex_instructions_per_microsecond();
+
+    if(storage_file_open(file, LATENCY_PROBE_LOG_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        for(size_t track = 0; track < LatencyTrackCount; track++) {
+            LatencyProbeTrack* probe = &latency_probe_tracks[track];
+            furi_string_printf(
+                line,
+                "%s: %zu records, us min/avg/max/p99\n",
+                latency_probe_track_names[track],
+                probe->count);
+            storage_file_write(file, furi_string_get_cstr(line), furi_string_size(line));
+            if(!probe->count) {
+                continue;
+            }
+            for(size_t stage = 0; stage < LatencyStageCount; stage++) {
+                uint32_t sorted[LATENCY_PROBE_RING];
+                uint64_t sum = 0;
+                for(size_t i = 0; i < probe->count; i++) {
+                    sorted[i] = probe->ring[i][stage];
+                    sum += sorted[i];
+                }
+                qsort(sorted, probe->count, sizeof(uint32_t), latency_probe_compare);
+                size_t p99 = (probe->count * 99 + 99) / 100 - 1;
+                furi_string_printf(
+                    line,
+                    "  %-10s %lu/%lu/%lu/%lu\n",
+                    latency_probe_stage_names[track][stage],
+                    sorted[0] / per_us,
+                    (uint32_t)(sum / probe->count) / per_us,
+                    sorted[probe->count - 1] / per_us,
+                    sorted[p99] / per_us);
+                storage_file_write(file, furi_string_get_cstr(line), furi_string_size(line));
+            }
+        }
+    }
+
+    furi_string_free(line);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+#endif
@@ -0,0 +1,85 @@
+/**
+ * @file latency_probe.h
+ * Cycle counter probes along the press, load and startup paths
+ *
+ * Every press, every remote load and the app start are one record in a ring
+ * buffer, holding how long each stage took. Aggregates over the ring are written
+ * to LATENCY_PROBE_LOG_PATH by latency_probe_dump(). Everything here is only
+ * compiled in debug builds, in release builds the macros expand to nothing.
+ */
+
+#pragma once
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef FURI_DEBUG
+#define LATENCY_PROBE_ENABLED 1
+#else
+#define LATENCY_PROBE_ENABLED 0
+#endif
+
+#define LATENCY_PROBE_LOG_PATH APP_DATA_PATH("latency.log")
+
+/** Which path a record belongs to */
+typedef enum {
+    LatencyTrackPress,
+    LatencyTrackLoad,
+    LatencyTrackStartup,
+    LatencyTrackCount
+} LatencyTrack;
+
+/** Points along a track, marked in order. Press and load use their own stages */
+typedef enum {
+    // press: input callback, item looked up, signal staged, worker started
+    LatencyStageInput = 0,
+    LatencyStageProcessOk,
+    LatencyStageStage,
+    LatencyStageTxStart,
+    // load: cache checked, .ir opened, name index scanned, bodies parsed
+    LatencyStageCache = 0,
+    LatencyStageOpen,
+    LatencyStageIndex,
+    LatencyStageParse,
+    // startup: records and views allocated, remote picked, remote loaded, first frame drawn
+    LatencyStageInit = 0,
+    LatencyStagePick,
+    LatencyStageLoadRemote,
+    LatencyStageFirstFrame,
+    LatencyStageCount = 4
+} LatencyStage;
+
+#if LATENCY_PROBE_ENABLED
+
+/** Start a new record on track, stages not marked before the end stay 0 */
+void latency_probe_begin(LatencyTrack track);
+
+/** Mark the end of stage on the record started last on track */
+void latency_probe_mark(LatencyTrack track, LatencyStage stage);
+
+/** Finish the record started last on track and add it to the ring */
+void latency_probe_end(LatencyTrack track);
+
+/** Write min/avg/max/p99 of every stage over the ring to LATENCY_PROBE_LOG_PATH */
+void latency_probe_dump(void);
+
+#define LATENCY_BEGIN(track)       latency_probe_begin(track)
+#define LATENCY_MARK(track, stage) latency_probe_mark(track, stage)
+#define LATENCY_END(track)         latency_probe_end(track)
+#define LATENCY_DUMP()             latency_probe_dump()
+
+#else
+
+#define LATENCY_BEGIN(track)
+#define LATENCY_MARK(track, stage)
+#define LATENCY_END(track)
+#define LATENCY_DUMP()
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,96 @@
+#include "remote_cache.h"
+
+#define TAG "FancyRemote"
+
+//heap an entry holds, the arena is most of it
+size_t entryBytes(const CachedRemote* entry) {
+    const Remote* remote = &entry->remote;
+    const RemoteLayout* layout = &entry->layout;
+    return remote->arena.size + sizeof(IrIndexEntry) * remote->index.capacity +
+           remote->index.namesCapacity + sizeof(LayoutButton) * layout->capacity +
+           sizeof(char*) * layout->nameCapacity + sizeof(SignalAlias) * layout->aliasCapacity +
+           sizeof(MacroStep) * layout->stepCapacity;
+}
+void freeEntry(CachedRemote* entry) {
+    remoteFree(&entry->remote);
+    layoutFree(&entry->layout);
+    remoteInit(&entry->remote);
+    layoutInit(&entry->layout);
+    entry->lastUsed = 0;
+}
+//least recently used entry other than keep, NULL if there is none
+CachedRemote* oldestEntry(RemoteCache* cache, const CachedRemote* keep) {
+    CachedRemote* oldest = NULL;
+    for(size_t i = 0; i < REMOTE_CACHE_SIZE; i++) {
+        CachedRemote* entry = &cache->entries[i];
+        if(entry != keep && entry->lastUsed &&
+           (!oldest || entry->lastUsed < oldest->lastUsed)) {
+            oldest = entry;
+        }
+    }
+    return oldest;
+}
+void remoteCacheInit(RemoteCache* cache, size_t budget) {
+    for(size_t i = 0; i < REMOTE_CACHE_SIZE; i++) {
+        remoteInit(&cache->entries[i].remote);
+        layoutInit(&cache->entries[i].layout);
+        cache->entries[i].lastUsed = 0;
+    }
+    cache->clock = 0;
+    cache->budget = budget;
+}
+void remoteCacheFree(RemoteCache* cache) {
+    for(size_t i = 0; i < REMOTE_CACHE_SIZE; i++) {
+        remoteFree(&cache->entries[i].remote);
+        layoutFree(&cache->entries[i].layout);
+    }
+}
+CachedRemote* remoteCacheOpen(RemoteCache* cache, const char* path) {
+    CachedRemote* entry = NULL;
+    for(size_t i = 0; i < REMOTE_CACHE_SIZE && !entry; i++) {
+        if(cache->entries[i].lastUsed &&
+           furi_string_equal_str(cache->entries[i].remote.path, path)) {
+            entry = &cache->entries[i];
+        }
+    }
+    if(!entry) {
+        //a free entry, or else the oldest one
+        for(size_t i = 0; i < REMOTE_CACHE_SIZE && !entry; i++) {
+            if(!cache->entries[i].lastUsed) {
+                entry = &cache->entries[i];
+            }
+        }
+        if(!entry) {
+            entry = oldestEntry(cache, NULL);
+        }
+        furi_string_set_str(entry->remote.path, path);
+        Storage* storage = furi_record_open(RECORD_STORAGE);
+        loadLayout(&entry->layout, storage, path);
+        furi_record_close(RECORD_STORAGE);
+        SignalNames names = layoutSignalNames(&entry->layout);
+        loadSignals(&entry->remote, &names);
+    }
+    entry->lastUsed = ++cache->clock;
+
+    size_t total = 0;
+    for(size_t i = 0; i < REMOTE_CACHE_SIZE; i++) {
+        if(cache->entries[i].lastUsed) {
+            total += entryBytes(&cache->entries[i]);
+        }
+    }
+    CachedRemote* oldest;
+    while(total > cache->budget && (oldest = oldestEntry(cache, entry))) {
+        total -= entryBytes(oldest);
+        FURI_LOG_D(TAG, "evicting %s", furi_string_get_cstr(oldest->remote.path));
+        freeEntry(oldest);
+    }
+    return entry;
+}
+CachedRemote* remoteCacheNext(RemoteCache* cache, CachedRemote* current) {
+    CachedRemote* next = oldestEntry(cache, current);
+    if(!next) {
+        return current;
+    }
+    next->lastUsed = ++cache->clock;
+    return next;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file remote_cache.h
+ * The last few remotes, kept parsed so switching between them is instant
+ *
+ * Every entry holds the layout and the preloaded signals of one .ir file.
+ * Opening a remote that is still cached touches nothing on the SD card. Entries
+ * are evicted least recently used first, when there are more than
+ * REMOTE_CACHE_SIZE or they take more than the budget together. The remote in
+ * use is never evicted.
+ */
+
+#pragma once
+
+#include "ir_remote.h"
+#include "remote_layout.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define REMOTE_CACHE_SIZE 4
+
+typedef struct {
+    Remote remote;
+    RemoteLayout layout;
+    //value of the cache clock when it was last opened, 0 for free entries
+    uint32_t lastUsed;
+} CachedRemote;
+
+typedef struct {
+    CachedRemote entries[REMOTE_CACHE_SIZE];
+    uint32_t clock;
+    //bytes all entries may hold together
+    size_t budget;
+} RemoteCache;
+
+/** Initialize an empty cache
+ *
+ * @param      cache   RemoteCache instance
+ * @param      budget  bytes all entries may hold together
+ */
+void remoteCacheInit(RemoteCache* cache, size_t budget);
+
+/** Free every entry
+ *
+ * @param      cache  RemoteCache instance
+ */
+void remoteCacheFree(RemoteCache* cache);
+
+/** Get a remote, loading it unless it is cached
+ *
+ * Entries other than the returned one may be evicted.
+ *
+ * @param      cache  RemoteCache instance
+ * @param      path   path of the .ir file
+ *
+ * @return     the entry, valid until another remote is opened
+ */
+CachedRemote* remoteCacheOpen(RemoteCache* cache, const char* path);
+
+/** Switch to the least recently used other remote
+ *
+ * Calling this repeatedly goes round every cached remote.
+ *
+ * @param      cache    RemoteCache instance
+ * @param      current  entry in use
+ *
+ * @return     the entry to use now, current when nothing else is cached
+ */
+CachedRemote* remoteCacheNext(RemoteCache* cache, CachedRemote* current);
+
+#ifdef __cplusplus
+}
+#endif
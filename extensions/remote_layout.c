@@ -0,0 +1,367 @@
+#include "remote_layout.h"
+
+#include <flipper_format.h>
+
+/* generated by fbt from .png files in images folder */
+#include <fancy_remote_icons.h>
+
+#define TAG "FancyRemote"
+#define LAYOUT_FILETYPE "Fancy Remote Layout"
+#define LAYOUT_VERSION 1
+//the panel numbers its cells in 16 bits
+#define LAYOUT_MAX_GRID 255
+#define LAYOUT_CELL_WORDS ((LAYOUT_MAX_GRID * LAYOUT_MAX_GRID + 31) / 32)
+//gap after a macro step that doesn't give one, enough for receivers to see separate presses
+#define LAYOUT_DEFAULT_GAP 100
+
+typedef struct {
+    const char* name;
+    const Icon* icon;
+    const Icon* iconSelected;
+} LayoutIcon;
+
+const LayoutIcon layoutIcons[] = {
+    {"power", &I_power_19x20, &I_power_hover_19x20},
+    {"volup", &I_volup_24x21, &I_volup_hover_24x21},
+    {"voldown", &I_voldown_24x21, &I_voldown_hover_24x21},
+    {"navup", &I_navup_24x18, &I_navup_hover_24x18},
+    {"navdown", &I_navdown_24x18, &I_navdown_hover_24x18},
+    {"navleft", &I_navleft_18x24, &I_navleft_hover_18x24},
+    {"navright", &I_navright_18x24, &I_navright_hover_18x24},
+    {"navok", &I_navok_24x24, &I_navok_hover_24x24}};
+
+typedef struct {
+    const char* name;
+    const char* icon;
+    uint16_t gridX;
+    uint16_t gridY;
+    uint16_t x;
+    uint16_t y;
+} DefaultButton;
+
+/*the TV layout, power on top, the navigation cross below it (24*18 or 18*24 arms around
+a 24*24 center) and volume at the bottom so volume down ends at the bottom of the screen*/
+const DefaultButton defaultLayout[] = {
+    {"Volume_up", "volup", 1, 4, 19, 85},
+    {"Volume_down", "voldown", 1, 5, 19, 107},
+    {"Navigate_left", "navleft", 0, 2, 2, 41},
+    {"Navigate_up", "navup", 1, 1, 20, 23},
+    {"Navigate_right", "navright", 2, 2, 44, 41},
+    {"Navigate_down", "navdown", 1, 3, 20, 65},
+    {"Power", "power", 1, 0, 22, 0},
+    {"Confirm", "navok", 1, 2, 20, 41}};
+
+//names other remotes use for the same buttons, the flipper's universal TV remote among them
+const char* const defaultAliases[][2] = {
+    {"Vol_up", "Volume_up"},
+    {"VOL+", "Volume_up"},
+    {"Vol_dn", "Volume_down"},
+    {"VOL-", "Volume_down"},
+    {"Up", "Navigate_up"},
+    {"Down", "Navigate_down"},
+    {"Left", "Navigate_left"},
+    {"Right", "Navigate_right"},
+    {"Ok", "Confirm"},
+    {"OK", "Confirm"}};
+
+const LayoutIcon* findIcon(const char* name) {
+    for(size_t i = 0; i < COUNT_OF(layoutIcons); i++) {
+        if(strcmp(layoutIcons[i].name, name) == 0) {
+            return &layoutIcons[i];
+        }
+    }
+    return NULL;
+}
+void clearLayout(RemoteLayout* layout) {
+    if(layout->ownsNames) {
+        for(size_t i = 0; i < layout->signalCount; i++) {
+            free((char*)layout->names[i]);
+        }
+    }
+    layout->signalCount = 0;
+    layout->stepCount = 0;
+    for(size_t i = 0; i < layout->aliasCount; i++) {
+        free((char*)layout->aliases[i].name);
+    }
+    layout->count = 0;
+    layout->aliasCount = 0;
+    layout->gridWidth = 0;
+    layout->gridHeight = 0;
+    layout->ownsNames = false;
+}
+//index of the signal sent for name
+uint32_t addName(RemoteLayout* layout, const char* name) {
+    if(layout->signalCount == layout->nameCapacity) {
+        layout->nameCapacity = layout->nameCapacity ? layout->nameCapacity * 2 : 16;
+        layout->names = realloc(layout->names, sizeof(char*) * layout->nameCapacity);
+    }
+    layout->names[layout->signalCount] = layout->ownsNames ? strdup(name) : name;
+    return layout->signalCount++;
+}
+uint32_t findName(RemoteLayout* layout, const char* name) {
+    for(size_t i = 0; i < layout->signalCount; i++) {
+        if(strcmp(layout->names[i], name) == 0) {
+            return i;
+        }
+    }
+    return addName(layout, name);
+}
+/*appends a button, false if its icon is unknown or its cell is out of range or taken.
+cells has a bit for every cell of the largest grid*/
+bool addButton(
+    RemoteLayout* layout,
+    uint32_t* cells,
+    const char* name,
+    const char* icon,
+    uint32_t gridX,
+    uint32_t gridY,
+    uint32_t x,
+    uint32_t y) {
+    const LayoutIcon* layoutIcon = findIcon(icon);
+    if(!layoutIcon || gridX >= LAYOUT_MAX_GRID || gridY >= LAYOUT_MAX_GRID) {
+        return false;
+    }
+    uint32_t cell = gridY * LAYOUT_MAX_GRID + gridX;
+    if(cells[cell / 32] & (1UL << (cell % 32))) {
+        return false;
+    }
+    cells[cell / 32] |= 1UL << (cell % 32);
+    if(layout->count == layout->capacity) {
+        layout->capacity = layout->capacity ? layout->capacity * 2 : 16;
+        layout->buttons = realloc(layout->buttons, sizeof(LayoutButton) * layout->capacity);
+    }
+    //buttons are all added before the names only macros use
+    furi_check(layout->signalCount == layout->count);
+    addName(layout, name);
+    LayoutButton* button = &layout->buttons[layout->count++];
+    button->icon = layoutIcon->icon;
+    button->iconSelected = layoutIcon->iconSelected;
+    button->gridX = gridX;
+    button->gridY = gridY;
+    button->x = x;
+    button->y = y;
+    button->isMacro = false;
+    button->firstStep = 0;
+    button->stepCount = 0;
+    button->repeat.gap = 0;
+    button->repeat.maxFrames = 0;
+    layout->gridWidth = MAX(layout->gridWidth, gridX + 1);
+    layout->gridHeight = MAX(layout->gridHeight, gridY + 1);
+    return true;
+}
+//false if the layout has no button called button
+bool addAlias(RemoteLayout* layout, const char* name, const char* button) {
+    for(size_t i = 0; i < layout->count; i++) {
+        if(strcmp(layout->names[i], button) == 0) {
+            if(layout->aliasCount == layout->aliasCapacity) {
+                layout->aliasCapacity = layout->aliasCapacity ? layout->aliasCapacity * 2 : 16;
+                layout->aliases =
+                    realloc(layout->aliases, sizeof(SignalAlias) * layout->aliasCapacity);
+            }
+            SignalAlias* alias = &layout->aliases[layout->aliasCount++];
+            alias->name = strdup(name);
+            alias->button = i;
+            return true;
+        }
+    }
+    return false;
+}
+//false if the layout has no button called button that sends its own signal
+bool setRepeat(RemoteLayout* layout, const char* button, uint32_t gap, uint32_t maxFrames) {
+    for(size_t i = 0; i < layout->count; i++) {
+        if(!layout->buttons[i].isMacro && strcmp(layout->names[i], button) == 0) {
+            layout->buttons[i].repeat.gap = MIN(gap, (uint32_t)UINT16_MAX);
+            layout->buttons[i].repeat.maxFrames = MIN(maxFrames, (uint32_t)UINT16_MAX);
+            return true;
+        }
+    }
+    return false;
+}
+/*reads steps: text into the steps of button, false if it doesn't start with an entry or
+has a gap that isn't a number. entries may start with a digit, gaps start with a +*/
+bool addSteps(RemoteLayout* layout, LayoutButton* button, const char* text) {
+    FuriString* token = furi_string_alloc();
+    button->firstStep = layout->stepCount;
+    button->stepCount = 0;
+    bool out = true;
+    while(out && *text) {
+        const char* end = text;
+        while(*end && *end != ' ') {
+            end++;
+        }
+        furi_string_set_strn(token, text, end - text);
+        text = *end ? end + 1 : end;
+        if(furi_string_empty(token)) {
+            continue;
+        }
+        const char* value = furi_string_get_cstr(token);
+        if(value[0] == '+') {
+            char* number = NULL;
+            uint32_t gap = strtoul(value + 1, &number, 10);
+            out = button->stepCount > 0 && number != value + 1 && *number == '\0';
+            if(out) {
+                layout->steps[layout->stepCount - 1].gap = gap;
+            }
+            continue;
+        }
+        uint32_t repeat = 1;
+        size_t star = furi_string_search_rchar(token, '*', 0);
+        if(star != FURI_STRING_FAILURE) {
+            repeat = strtoul(value + star + 1, NULL, 10);
+            furi_string_left(token, star);
+        }
+        if(layout->stepCount == layout->stepCapacity) {
+            layout->stepCapacity = layout->stepCapacity ? layout->stepCapacity * 2 : 16;
+            layout->steps = realloc(layout->steps, sizeof(MacroStep) * layout->stepCapacity);
+        }
+        MacroStep* step = &layout->steps[layout->stepCount++];
+        step->signal = findName(layout, furi_string_get_cstr(token));
+        step->repeat = MIN(repeat, (uint32_t)UINT16_MAX);
+        step->gap = LAYOUT_DEFAULT_GAP;
+        button->stepCount++;
+    }
+    furi_string_free(token);
+    return out;
+}
+/*reads the buttons of a sidecar, then its macros and their steps, then its aliases and
+repeat timings. false if it is no layout or has a broken button*/
+bool readLayout(RemoteLayout* layout, FlipperFormat* ff, uint32_t* cells) {
+    FuriString* name = furi_string_alloc();
+    FuriString* value = furi_string_alloc();
+    uint32_t version;
+    bool loaded = flipper_format_read_header(ff, name, &version) &&
+                  furi_string_equal_str(name, LAYOUT_FILETYPE) && version == LAYOUT_VERSION;
+    uint32_t position[4];
+    for(size_t pass = 0; pass < 2; pass++) {
+        const char* key = pass ? "macro" : "name";
+        while(loaded && flipper_format_read_string(ff, key, name)) {
+            loaded = flipper_format_read_string(ff, "icon", value) &&
+                     flipper_format_read_uint32(ff, "position", position, 4) &&
+                     addButton(
+                         layout,
+                         cells,
+                         furi_string_get_cstr(name),
+                         furi_string_get_cstr(value),
+                         position[0],
+                         position[1],
+                         position[2],
+                         position[3]);
+            if(loaded && pass) {
+                layout->buttons[layout->count - 1].isMacro = true;
+            }
+        }
+        loaded = loaded && flipper_format_rewind(ff);
+    }
+    loaded = loaded && layout->count > 0;
+    //the panel reserves every cell of the grid, a few far apart buttons would not fit
+    if(loaded && (uint32_t)layout->gridWidth * layout->gridHeight > LAYOUT_MAX_CELLS) {
+        FURI_LOG_W(
+            TAG,
+            "grid of %ux%u is over %u cells",
+            layout->gridWidth,
+            layout->gridHeight,
+            LAYOUT_MAX_CELLS);
+        loaded = false;
+    }
+
+    //the macros were added in file order after the other buttons
+    size_t macro = 0;
+    while(macro < layout->count && !layout->buttons[macro].isMacro) {
+        macro++;
+    }
+    while(loaded && macro < layout->count && flipper_format_read_string(ff, "macro", name)) {
+        loaded = flipper_format_read_string(ff, "steps", value) &&
+                 addSteps(layout, &layout->buttons[macro++], furi_string_get_cstr(value));
+    }
+    loaded = loaded && macro == layout->count && flipper_format_rewind(ff);
+
+    while(loaded && flipper_format_read_string(ff, "alias", name) &&
+          flipper_format_read_string(ff, "button", value)) {
+        if(!addAlias(layout, furi_string_get_cstr(name), furi_string_get_cstr(value))) {
+            FURI_LOG_W(
+                TAG,
+                "alias %s is for missing button %s",
+                furi_string_get_cstr(name),
+                furi_string_get_cstr(value));
+        }
+    }
+    loaded = loaded && flipper_format_rewind(ff);
+
+    uint32_t timing[2];
+    while(loaded && flipper_format_read_string(ff, "repeat", name) &&
+          flipper_format_read_uint32(ff, "timing", timing, 2)) {
+        if(!setRepeat(layout, furi_string_get_cstr(name), timing[0], timing[1])) {
+            FURI_LOG_W(TAG, "repeat is for missing button %s", furi_string_get_cstr(name));
+        }
+    }
+    furi_string_free(value);
+    furi_string_free(name);
+    return loaded;
+}
+void layoutInit(RemoteLayout* layout) {
+    memset(layout, 0, sizeof(RemoteLayout));
+}
+void layoutFree(RemoteLayout* layout) {
+    clearLayout(layout);
+    free(layout->buttons);
+    free(layout->names);
+    free(layout->aliases);
+    free(layout->steps);
+    layout->buttons = NULL;
+    layout->names = NULL;
+    layout->aliases = NULL;
+    layout->steps = NULL;
+    layout->capacity = 0;
+    layout->nameCapacity = 0;
+    layout->aliasCapacity = 0;
+    layout->stepCapacity = 0;
+}
+void loadLayout(RemoteLayout* layout, Storage* storage, const char* path) {
+    clearLayout(layout);
+    uint32_t* cells = malloc(sizeof(uint32_t) * LAYOUT_CELL_WORDS);
+    memset(cells, 0, sizeof(uint32_t) * LAYOUT_CELL_WORDS);
+    FuriString* layoutPath = furi_string_alloc_printf("%s" LAYOUT_EXTENSION, path);
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
+    bool loaded = false;
+    if(flipper_format_buffered_file_open_existing(ff, furi_string_get_cstr(layoutPath))) {
+        layout->ownsNames = true;
+        loaded = readLayout(layout, ff, cells);
+        if(!loaded) {
+            FURI_LOG_W(
+                TAG,
+                "%s is broken, using the built-in layout",
+                furi_string_get_cstr(layoutPath));
+        }
+    }
+    flipper_format_buffered_file_close(ff);
+    flipper_format_free(ff);
+    furi_string_free(layoutPath);
+    if(!loaded) {
+        clearLayout(layout);
+        memset(cells, 0, sizeof(uint32_t) * LAYOUT_CELL_WORDS);
+        for(size_t i = 0; i < COUNT_OF(defaultLayout); i++) {
+            const DefaultButton* button = &defaultLayout[i];
+            addButton(
+                layout,
+                cells,
+                button->name,
+                button->icon,
+                button->gridX,
+                button->gridY,
+                button->x,
+                button->y);
+        }
+    }
+    free(cells);
+    for(size_t i = 0; i < COUNT_OF(defaultAliases); i++) {
+        addAlias(layout, defaultAliases[i][0], defaultAliases[i][1]);
+    }
+}
+SignalNames layoutSignalNames(const RemoteLayout* layout) {
+    SignalNames names = {
+        .names = layout->names,
+        .count = layout->signalCount,
+        .aliases = layout->aliases,
+        .aliasCount = layout->aliasCount};
+    return names;
+}
@@ -0,0 +1,131 @@
+/**
+ * @file remote_layout.h
+ * Which buttons a remote shows and where
+ *
+ * A layout lists the .ir entry, icon, grid cell and pixel position of every
+ * button. It is read from a sidecar next to the .ir file, <remote>.ir.layout,
+ * and falls back to the built-in TV layout when there is none:
+ *
+ *     Filetype: Fancy Remote Layout
+ *     Version: 1
+ *     name: Power
+ *     icon: power
+ *     position: 1 0 22 0
+ *
+ * position is grid x, grid y, pixel x, pixel y. Grid cells are only used for
+ * navigation and every button needs its own. A layout whose grid spans more than
+ * LAYOUT_MAX_CELLS cells is not used. Icons are looked up by name, see
+ * layoutIcons in remote_layout.c. After the buttons, any number of
+ *
+ *     alias: VOL+
+ *     button: Volume_up
+ *
+ * let a button be sent from an entry with another name. A few common aliases
+ * are built in, see defaultAliases. A macro button sends other entries in turn:
+ *
+ *     macro: Movie
+ *     icon: navok
+ *     position: 0 6 2 130
+ *     steps: Power +3000 Input_3 +500 Volume_down*5 +150
+ *
+ * Every entry can have a repeat count after a *, a + and a number is the gap in
+ * ms after every send of the entry before it. Entries like 3 are names, not
+ * gaps. Every macro needs its steps. Also,
+ *
+ *     repeat: Volume_up
+ *     timing: 150 10
+ *
+ * makes a held button wait 150ms after every frame and stop after 10 frames, 0
+ * for no limit. Without one a button repeats back to back until released.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/icon.h>
+#include <storage/storage.h>
+
+#include "ir_remote.h"
+#include "ir_macro.h"
+#include "ir_transmitter.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LAYOUT_EXTENSION ".layout"
+/*most cells the grid of a layout may span, width times height. the panel keeps about 32
+bytes for every cell, used or not*/
+#define LAYOUT_MAX_CELLS 1024
+
+typedef struct {
+    const Icon* icon;
+    const Icon* iconSelected;
+    uint16_t gridX;
+    uint16_t gridY;
+    uint16_t x;
+    uint16_t y;
+    //sends steps[firstStep] to steps[firstStep + stepCount - 1] instead of its own signal
+    bool isMacro;
+    uint32_t firstStep;
+    uint32_t stepCount;
+    RepeatPolicy repeat;
+} LayoutButton;
+
+typedef struct {
+    /*names[i] is the .ir entry sent by buttons[i], after the buttons come the entries
+    that are only sent by macros*/
+    const char** names;
+    size_t signalCount;
+    size_t nameCapacity;
+    LayoutButton* buttons;
+    size_t count;
+    size_t capacity;
+    MacroStep* steps;
+    size_t stepCount;
+    size_t stepCapacity;
+    //alias names are always copied
+    SignalAlias* aliases;
+    size_t aliasCount;
+    size_t aliasCapacity;
+    //one more than the largest grid x and y
+    uint16_t gridWidth;
+    uint16_t gridHeight;
+    //names were copied from a sidecar and have to be freed
+    bool ownsNames;
+} RemoteLayout;
+
+/** Initialize an empty layout
+ *
+ * @param      layout  RemoteLayout instance
+ */
+void layoutInit(RemoteLayout* layout);
+
+/** Free everything the layout holds
+ *
+ * @param      layout  RemoteLayout instance
+ */
+void layoutFree(RemoteLayout* layout);
+
+/** Load the layout for a remote, one pass over its sidecar for every kind of block
+ *
+ * A missing or malformed sidecar gives the built-in layout, so the result always
+ * has at least one button.
+ *
+ * @param      layout   RemoteLayout instance
+ * @param      storage  Storage instance
+ * @param      path     path of the .ir file
+ */
+void loadLayout(RemoteLayout* layout, Storage* storage, const char* path);
+
+/** Names and aliases of the layout, for loadSignals()
+ *
+ * @param      layout  RemoteLayout instance
+ *
+ * @return     names pointing into the layout, valid until it is loaded again
+ */
+SignalNames layoutSignalNames(const RemoteLayout* layout);
+
+#ifdef __cplusplus
+}
+#endif
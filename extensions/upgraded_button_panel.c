@@ -1,6 +1,8 @@
 #include "upgraded_button_panel.h"
+#include "latency_probe.h"
 
 #include <gui/canvas.h>
+#include <gui/canvas_i.h>
 #include <gui/elements.h>
 
 #include <input/input.h>
@@ -8,8 +10,8 @@
 #include <furi.h>
 #include <furi_hal_resources.h>
 #include <stdint.h>
+#include <stdlib.h>
 
-#include <m-array.h>
 #include <m-i-list.h>
 #include <m-list.h>
 
@@ -41,34 +43,80 @@ typedef struct ButtonItem {
     void* callback_context;
 } ButtonItem;
 
-ARRAY_DEF(ButtonArray, ButtonItem*, M_PTR_OPLIST); // NOLINT
-#define M_OPL_ButtonArray_t() ARRAY_OPLIST(ButtonArray, M_PTR_OPLIST)
-ARRAY_DEF(ButtonMatrix, ButtonArray_t);
-#define M_OPL_ButtonMatrix_t() ARRAY_OPLIST(ButtonMatrix, M_OPL_ButtonArray_t())
-
 struct UpgradedButtonPanel {
     View* view;
     bool freeze;
+    ButtonSelectCallback select_callback;
+    void* select_context;
+    ButtonBackLongCallback back_long_callback;
+    void* back_long_context;
+    // last item reported to select_callback
+    ButtonItem* selected_item;
 };
 
+typedef enum {
+    UpgradedButtonPanelDirectionUp,
+    UpgradedButtonPanelDirectionDown,
+    UpgradedButtonPanelDirectionLeft,
+    UpgradedButtonPanelDirectionRight,
+    UpgradedButtonPanelDirectionCount
+} UpgradedButtonPanelDirection;
+
+#define UPGRADED_BUTTON_PANEL_NO_SLOT UINT16_MAX
+// the view is vertical, anything taller scrolls
+#define UPGRADED_BUTTON_PANEL_SCREEN_HEIGHT 128
+// labels are drawn from their baseline, this is enough for the biggest font
+#define UPGRADED_BUTTON_PANEL_LABEL_HEIGHT 16
+
 typedef struct {
-    ButtonMatrix_t button_matrix;
+    // reserve_x * reserve_y slots, row by row, then the neighbour table, one occupancy bit
+    // per slot and the row bounds and order, all in one block
+    ButtonItem* buttons;
+    // slot each direction moves to from every slot and the grid rows with buttons, rebuilt on
+    // the first move or draw after the layout changes. the rows are ordered by their top
+    // pixel row, which need not follow the grid, and keep that top, their bottom and the
+    // lowest bottom of them and every row before, so a frame can find its first row
+    uint16_t (*neighbours)[UpgradedButtonPanelDirectionCount];
+    uint16_t (*row_bounds)[3];
+    uint16_t* row_order;
+    uint16_t row_count;
+    // set by layout changes, cleared by whichever of a move or a draw builds the layout
+    bool layout_dirty;
+    uint32_t* occupied;
     IconList_t icons;
     LabelList_t labels;
     uint16_t reserve_x;
     uint16_t reserve_y;
-    uint16_t selected_item_x;
-    uint16_t selected_item_y;
+    // selected slot in the low half and the first pixel row on screen in the high half.
+    // only the input callback moves it, the draw callback reads it without any lock
+    uint32_t selection;
+    // held while the layout changes and while a frame is drawn, never by navigation or OK
+    FuriMutex* layout_mutex;
+    // copy of the last drawn frame, only the buttons whose selection changed are redrawn
+    // on top of it until the layout changes. with static_background it is drawn with no
+    // button selected and only the selected button is drawn on top
+    uint8_t* frame;
+    size_t frame_size;
+    size_t frame_selected;
+    uint16_t frame_scroll_y;
+    bool frame_dirty;
+    bool static_background;
 } UpgradedButtonPanelModel;
 
-static ButtonItem**
+#define UPGRADED_BUTTON_PANEL_SELECTION(slot, scroll_y) (((uint32_t)(scroll_y) << 16) | (slot))
+#define UPGRADED_BUTTON_PANEL_SELECTED_SLOT(selection)  ((selection) & 0xFFFF)
+#define UPGRADED_BUTTON_PANEL_SCROLL_Y(selection)       ((selection) >> 16)
+
+static ButtonItem*
     upgraded_button_panel_get_item(UpgradedButtonPanelModel* model, size_t x, size_t y);
-static void upgraded_button_panel_process_up(UpgradedButtonPanel* upgraded_button_panel);
-static void upgraded_button_panel_process_down(UpgradedButtonPanel* upgraded_button_panel);
-static void upgraded_button_panel_process_left(UpgradedButtonPanel* upgraded_button_panel);
-static void upgraded_button_panel_process_right(UpgradedButtonPanel* upgraded_button_panel);
+static void upgraded_button_panel_build_layout(UpgradedButtonPanelModel* model);
+static void upgraded_button_panel_process_move(
+    UpgradedButtonPanel* upgraded_button_panel,
+    UpgradedButtonPanelDirection direction,
+    bool page);
 static void
     upgraded_button_panel_process_ok(UpgradedButtonPanel* upgraded_button_panel, InputType type);
+static void upgraded_button_panel_process_select(UpgradedButtonPanel* upgraded_button_panel);
 static void upgraded_button_panel_view_draw_callback(Canvas* canvas, void* _model);
 static bool upgraded_button_panel_view_input_callback(InputEvent* event, void* context);
 
@@ -77,8 +125,9 @@ UpgradedButtonPanel* upgraded_button_panel_alloc(void) {
     upgraded_button_panel->view = view_alloc();
     view_set_orientation(upgraded_button_panel->view, ViewOrientationVertical);
     view_set_context(upgraded_button_panel->view, upgraded_button_panel);
+    // lock free so navigation never waits for a frame, layout_mutex guards the layout
     view_allocate_model(
-        upgraded_button_panel->view, ViewModelTypeLocking, sizeof(UpgradedButtonPanelModel));
+        upgraded_button_panel->view, ViewModelTypeLockFree, sizeof(UpgradedButtonPanelModel));
     view_set_draw_callback(upgraded_button_panel->view, upgraded_button_panel_view_draw_callback);
     view_set_input_callback(
         upgraded_button_panel->view, upgraded_button_panel_view_input_callback);
@@ -89,13 +138,29 @@ UpgradedButtonPanel* upgraded_button_panel_alloc(void) {
         {
             model->reserve_x = 0;
             model->reserve_y = 0;
-            model->selected_item_x = 0;
-            model->selected_item_y = 0;
-            ButtonMatrix_init(model->button_matrix);
+            model->selection = UPGRADED_BUTTON_PANEL_SELECTION(0, 0);
+            model->layout_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+            model->buttons = NULL;
+            model->neighbours = NULL;
+            model->row_bounds = NULL;
+            model->row_order = NULL;
+            model->row_count = 0;
+            model->layout_dirty = false;
+            model->occupied = NULL;
+            model->frame = NULL;
+            model->frame_size = 0;
+            model->frame_selected = 0;
+            model->frame_dirty = true;
+            model->static_background = false;
             LabelList_init(model->labels);
         },
         true);
     upgraded_button_panel->freeze = false;
+    upgraded_button_panel->select_callback = NULL;
+    upgraded_button_panel->select_context = NULL;
+    upgraded_button_panel->back_long_callback = NULL;
+    upgraded_button_panel->back_long_context = NULL;
+    upgraded_button_panel->selected_item = NULL;
 
     return upgraded_button_panel;
 }
@@ -106,20 +171,32 @@ void upgraded_button_panel_reserve(
     size_t reserve_y) {
     furi_check(reserve_x > 0);
     furi_check(reserve_y > 0);
+    furi_check(reserve_x * reserve_y < UPGRADED_BUTTON_PANEL_NO_SLOT);
 
     with_view_model(
         upgraded_button_panel->view,
         UpgradedButtonPanelModel * model,
         {
+            size_t slots = reserve_x * reserve_y;
+            size_t words = (slots + 31) / 32;
+            furi_mutex_acquire(model->layout_mutex, FuriWaitForever);
+            free(model->buttons);
             model->reserve_x = reserve_x;
             model->reserve_y = reserve_y;
-            ButtonMatrix_reserve(model->button_matrix, model->reserve_y);
-            for(size_t i = 0; i > model->reserve_y; ++i) {
-                ButtonArray_t* array = ButtonMatrix_get(model->button_matrix, i);
-                ButtonArray_init(*array);
-                ButtonArray_reserve(*array, reserve_x);
-            }
+            model->buttons = malloc(
+                (sizeof(ButtonItem) + sizeof(*model->neighbours)) * slots +
+                sizeof(uint32_t) * words +
+                (sizeof(*model->row_bounds) + sizeof(*model->row_order)) * reserve_y);
+            model->neighbours = (void*)(model->buttons + slots);
+            model->occupied = (uint32_t*)(model->neighbours + slots);
+            model->row_bounds = (void*)(model->occupied + words);
+            model->row_order = (uint16_t*)(model->row_bounds + reserve_y);
+            model->row_count = 0;
+            model->layout_dirty = true;
+            model->frame_dirty = true;
+            memset(model->occupied, 0, sizeof(uint32_t) * words);
             LabelList_init(model->labels);
+            furi_mutex_release(model->layout_mutex);
         },
         true);
 }
@@ -134,7 +211,8 @@ void upgraded_button_panel_free(UpgradedButtonPanel* upgraded_button_panel) {
         UpgradedButtonPanelModel * model,
         {
             LabelList_clear(model->labels);
-            ButtonMatrix_clear(model->button_matrix);
+            free(model->frame);
+            furi_mutex_free(model->layout_mutex);
         },
         true);
 
@@ -149,33 +227,53 @@ void upgraded_button_panel_reset(UpgradedButtonPanel* upgraded_button_panel) {
         upgraded_button_panel->view,
         UpgradedButtonPanelModel * model,
         {
-            for(size_t x = 0; x < model->reserve_x; ++x) {
-                for(size_t y = 0; y < model->reserve_y; ++y) {
-                    ButtonItem** button_item = upgraded_button_panel_get_item(model, x, y);
-                    free(*button_item);
-                    *button_item = NULL;
-                }
-            }
+            furi_mutex_acquire(model->layout_mutex, FuriWaitForever);
+            free(model->buttons);
+            model->buttons = NULL;
+            model->neighbours = NULL;
+            model->row_bounds = NULL;
+            model->row_order = NULL;
+            model->row_count = 0;
+            model->occupied = NULL;
             model->reserve_x = 0;
             model->reserve_y = 0;
-            model->selected_item_x = 0;
-            model->selected_item_y = 0;
+            model->selection = UPGRADED_BUTTON_PANEL_SELECTION(0, 0);
+            model->frame_dirty = true;
             LabelList_reset(model->labels);
             IconList_reset(model->icons);
-            ButtonMatrix_reset(model->button_matrix);
+            furi_mutex_release(model->layout_mutex);
         },
         true);
+    upgraded_button_panel->selected_item = NULL;
 }
 
-static ButtonItem**
+static inline bool
+    upgraded_button_panel_slot_occupied(UpgradedButtonPanelModel* model, size_t slot) {
+    return model->occupied[slot / 32] & (1UL << (slot % 32));
+}
+
+// NULL for empty slots
+static ButtonItem*
     upgraded_button_panel_get_item(UpgradedButtonPanelModel* model, size_t x, size_t y) {
     furi_assert(model);
 
     furi_check(x < model->reserve_x);
     furi_check(y < model->reserve_y);
-    ButtonArray_t* button_array = ButtonMatrix_safe_get(model->button_matrix, x);
-    ButtonItem** button_item = ButtonArray_safe_get(*button_array, y);
-    return button_item;
+    size_t slot = y * model->reserve_x + x;
+    if(!upgraded_button_panel_slot_occupied(model, slot)) {
+        return NULL;
+    }
+    return &model->buttons[slot];
+}
+
+// NULL for empty slots and slots past the layout
+static ButtonItem*
+    upgraded_button_panel_slot_item(UpgradedButtonPanelModel* model, size_t slot) {
+    if(slot >= (size_t)(model->reserve_x * model->reserve_y) ||
+       !upgraded_button_panel_slot_occupied(model, slot)) {
+        return NULL;
+    }
+    return &model->buttons[slot];
 }
 
 void upgraded_button_panel_add_item(
@@ -195,11 +293,14 @@ void upgraded_button_panel_add_item(
         upgraded_button_panel->view,
         UpgradedButtonPanelModel * model,
         {
-            ButtonItem** button_item_ptr =
-                upgraded_button_panel_get_item(model, matrix_place_x, matrix_place_y);
-            furi_check(*button_item_ptr == NULL);
-            *button_item_ptr = malloc(sizeof(ButtonItem));
-            ButtonItem* button_item = *button_item_ptr;
+            furi_mutex_acquire(model->layout_mutex, FuriWaitForever);
+            furi_check(
+                !upgraded_button_panel_get_item(model, matrix_place_x, matrix_place_y));
+            size_t slot = matrix_place_y * model->reserve_x + matrix_place_x;
+            model->occupied[slot / 32] |= 1UL << (slot % 32);
+            model->layout_dirty = true;
+            model->frame_dirty = true;
+            ButtonItem* button_item = &model->buttons[slot];
             button_item->callback = callback;
             button_item->callback_context = callback_context;
             button_item->icon.x = x;
@@ -207,6 +308,42 @@ void upgraded_button_panel_add_item(
             button_item->icon.name = icon_name;
             button_item->icon.name_selected = icon_name_selected;
             button_item->index = index;
+            furi_mutex_release(model->layout_mutex);
+        },
+        true);
+}
+
+void upgraded_button_panel_set_select_callback(
+    UpgradedButtonPanel* upgraded_button_panel,
+    ButtonSelectCallback callback,
+    void* context) {
+    furi_check(upgraded_button_panel);
+    upgraded_button_panel->select_callback = callback;
+    upgraded_button_panel->select_context = context;
+}
+
+void upgraded_button_panel_set_back_long_callback(
+    UpgradedButtonPanel* upgraded_button_panel,
+    ButtonBackLongCallback callback,
+    void* context) {
+    furi_check(upgraded_button_panel);
+    upgraded_button_panel->back_long_callback = callback;
+    upgraded_button_panel->back_long_context = context;
+}
+
+void upgraded_button_panel_set_static_background(
+    UpgradedButtonPanel* upgraded_button_panel,
+    bool enabled) {
+    furi_check(upgraded_button_panel);
+
+    with_view_model(
+        upgraded_button_panel->view,
+        UpgradedButtonPanelModel * model,
+        {
+            furi_mutex_acquire(model->layout_mutex, FuriWaitForever);
+            model->static_background = enabled;
+            model->frame_dirty = true;
+            furi_mutex_release(model->layout_mutex);
         },
         true);
 }
@@ -216,167 +353,332 @@ View* upgraded_button_panel_get_view(UpgradedButtonPanel* upgraded_button_panel)
     return upgraded_button_panel->view;
 }
 
-static void upgraded_button_panel_view_draw_callback(Canvas* canvas, void* _model) {
-    furi_assert(canvas);
-    furi_assert(_model);
+static uint16_t upgraded_button_panel_item_height(const ButtonItem* button_item) {
+    return MAX(
+        icon_get_height(button_item->icon.name), icon_get_height(button_item->icon.name_selected));
+}
 
-    UpgradedButtonPanelModel* model = _model;
+// Clear the rectangle of one button and draw it again on top of the retained frame.
+// Labels and icons overlapping a button are not redrawn.
+static void upgraded_button_panel_draw_slot(
+    Canvas* canvas,
+    UpgradedButtonPanelModel* model,
+    size_t slot,
+    uint16_t scroll_y,
+    bool selected) {
+    ButtonItem* button_item = upgraded_button_panel_slot_item(model, slot);
+    if(!button_item) {
+        return;
+    }
+    const IconElement* icon = &button_item->icon;
+    int32_t y = (int32_t)icon->y - scroll_y;
+    canvas_set_color(canvas, ColorWhite);
+    canvas_draw_box(
+        canvas,
+        icon->x,
+        y,
+        MAX(icon_get_width(icon->name), icon_get_width(icon->name_selected)),
+        upgraded_button_panel_item_height(button_item));
+    canvas_set_color(canvas, ColorBlack);
+    canvas_draw_icon(canvas, icon->x, y, selected ? icon->name_selected : icon->name);
+}
+
+// Called with layout_mutex held
+static void upgraded_button_panel_draw(Canvas* canvas, UpgradedButtonPanelModel* model) {
+    uint8_t* buffer = canvas_get_buffer(canvas);
+    size_t buffer_size = canvas_get_buffer_size(canvas);
+    // one read, so the slot and the scroll position always belong together
+    uint32_t selection = __atomic_load_n(&model->selection, __ATOMIC_ACQUIRE);
+    size_t selected = UPGRADED_BUTTON_PANEL_SELECTED_SLOT(selection);
+    uint16_t scroll_y = UPGRADED_BUTTON_PANEL_SCROLL_Y(selection);
+    int32_t top = scroll_y;
+    int32_t bottom = top + UPGRADED_BUTTON_PANEL_SCREEN_HEIGHT;
+
+    if(model->layout_dirty) {
+        upgraded_button_panel_build_layout(model);
+    }
+
+    if(!model->frame_dirty && model->frame_size == buffer_size &&
+       model->frame_scroll_y == scroll_y) {
+        memcpy(buffer, model->frame, buffer_size);
+        if(model->static_background) {
+            upgraded_button_panel_draw_slot(canvas, model, selected, scroll_y, true);
+        } else if(selected != model->frame_selected) {
+            upgraded_button_panel_draw_slot(
+                canvas, model, model->frame_selected, scroll_y, false);
+            upgraded_button_panel_draw_slot(canvas, model, selected, scroll_y, true);
+            memcpy(model->frame, buffer, buffer_size);
+            model->frame_selected = selected;
+        }
+        return;
+    }
 
     canvas_clear(canvas);
     canvas_set_color(canvas, ColorBlack);
 
+    // only what overlaps the screen is drawn, however tall the panel is
     for
         M_EACH(icon, model->icons, IconList_t) {
-            canvas_draw_icon(canvas, icon->x, icon->y, icon->name);
+            if(icon->y < bottom && icon->y + icon_get_height(icon->name) > top) {
+                canvas_draw_icon(canvas, icon->x, icon->y - top, icon->name);
+            }
         }
 
-    for(size_t x = 0; x < model->reserve_x; ++x) {
-        for(size_t y = 0; y < model->reserve_y; ++y) {
-            ButtonItem* button_item = *upgraded_button_panel_get_item(model, x, y);
-            if(!button_item) {
+    // the first row that can reach the screen is the first whose lowest bottom so far is
+    // below its top, and rows from the first one that starts below the screen are all off it
+    size_t row = 0;
+    size_t rows_left = model->row_count;
+    while(rows_left) {
+        size_t half = rows_left / 2;
+        if(model->row_bounds[row + half][2] <= top) {
+            row += half + 1;
+            rows_left -= half + 1;
+        } else {
+            rows_left = half;
+        }
+    }
+    for(; row < model->row_count && model->row_bounds[row][0] < bottom; ++row) {
+        if(model->row_bounds[row][1] <= top) {
+            continue;
+        }
+        size_t y = model->row_order[row];
+        for(size_t x = 0; x < model->reserve_x; ++x) {
+            size_t slot = y * model->reserve_x + x;
+            if(!upgraded_button_panel_slot_occupied(model, slot)) {
                 continue;
             }
+            ButtonItem* button_item = &model->buttons[slot];
             const Icon* icon_name = button_item->icon.name;
-            if((model->selected_item_x == x) && (model->selected_item_y == y)) {
+            if(slot == selected && !model->static_background) {
                 icon_name = button_item->icon.name_selected;
             }
-            canvas_draw_icon(canvas, button_item->icon.x, button_item->icon.y, icon_name);
+            canvas_draw_icon(canvas, button_item->icon.x, button_item->icon.y - top, icon_name);
         }
     }
 
     for
         M_EACH(label, model->labels, LabelList_t) {
-            canvas_set_font(canvas, label->font);
-            canvas_draw_str(canvas, label->x, label->y, label->str);
+            if(label->y > top && label->y < bottom + UPGRADED_BUTTON_PANEL_LABEL_HEIGHT) {
+                canvas_set_font(canvas, label->font);
+                canvas_draw_str(canvas, label->x, label->y - top, label->str);
+            }
         }
-}
 
-static void upgraded_button_panel_process_down(UpgradedButtonPanel* upgraded_button_panel) {
-    with_view_model(
-        upgraded_button_panel->view,
-        UpgradedButtonPanelModel * model,
-        {
-            uint16_t new_selected_item_x = model->selected_item_x;
-            uint16_t new_selected_item_y = model->selected_item_y;
-            size_t i;
+    if(model->frame_size != buffer_size) {
+        free(model->frame);
+        model->frame = malloc(buffer_size);
+        model->frame_size = buffer_size;
+    }
+    memcpy(model->frame, buffer, buffer_size);
+    model->frame_selected = selected;
+    model->frame_scroll_y = scroll_y;
+    model->frame_dirty = false;
 
-            if(new_selected_item_y < (model->reserve_y - 1)) {
-                ++new_selected_item_y;
+    if(model->static_background) {
+        upgraded_button_panel_draw_slot(canvas, model, selected, scroll_y, true);
+    }
+}
 
-                for(i = 0; i < model->reserve_x; ++i) {
-                    new_selected_item_x = (model->selected_item_x + i) % model->reserve_x;
-                    if(*upgraded_button_panel_get_item(
-                           model, new_selected_item_x, new_selected_item_y)) {
-                        break;
-                    }
-                }
-                if(i != model->reserve_x) {
-                    model->selected_item_x = new_selected_item_x;
-                    model->selected_item_y = new_selected_item_y;
-                }
-            }
-        },
-        true);
+static void upgraded_button_panel_view_draw_callback(Canvas* canvas, void* _model) {
+    furi_assert(canvas);
+    furi_assert(_model);
+
+    UpgradedButtonPanelModel* model = _model;
+    furi_mutex_acquire(model->layout_mutex, FuriWaitForever);
+    upgraded_button_panel_draw(canvas, model);
+    furi_mutex_release(model->layout_mutex);
+    // the first frame ends the startup record, later frames find it closed
+    LATENCY_MARK(LatencyTrackStartup, LatencyStageFirstFrame);
+    LATENCY_END(LatencyTrackStartup);
 }
 
-static void upgraded_button_panel_process_up(UpgradedButtonPanel* upgraded_button_panel) {
-    with_view_model(
-        upgraded_button_panel->view,
-        UpgradedButtonPanelModel * model,
-        {
-            size_t new_selected_item_x = model->selected_item_x;
-            size_t new_selected_item_y = model->selected_item_y;
-            size_t i;
+// Slot that a move from (x, y) lands on, the scan the neighbour table is built from
+static uint16_t upgraded_button_panel_scan(
+    UpgradedButtonPanelModel* model,
+    size_t x,
+    size_t y,
+    UpgradedButtonPanelDirection direction) {
+    bool vertical = (direction == UpgradedButtonPanelDirectionUp) ||
+                    (direction == UpgradedButtonPanelDirectionDown);
+    if(direction == UpgradedButtonPanelDirectionUp) {
+        if(y == 0) {
+            return UPGRADED_BUTTON_PANEL_NO_SLOT;
+        }
+        --y;
+    } else if(direction == UpgradedButtonPanelDirectionDown) {
+        if(y >= (size_t)(model->reserve_y - 1)) {
+            return UPGRADED_BUTTON_PANEL_NO_SLOT;
+        }
+        ++y;
+    } else if(direction == UpgradedButtonPanelDirectionLeft) {
+        if(x == 0) {
+            return UPGRADED_BUTTON_PANEL_NO_SLOT;
+        }
+        --x;
+    } else {
+        if(x >= (size_t)(model->reserve_x - 1)) {
+            return UPGRADED_BUTTON_PANEL_NO_SLOT;
+        }
+        ++x;
+    }
 
-            if(new_selected_item_y > 0) {
-                --new_selected_item_y;
+    // first occupied cell of the new row or column, starting at the current one and wrapping
+    size_t length = vertical ? model->reserve_x : model->reserve_y;
+    for(size_t i = 0; i < length; ++i) {
+        size_t new_x = vertical ? (x + i) % model->reserve_x : x;
+        size_t new_y = vertical ? y : (y + i) % model->reserve_y;
+        if(upgraded_button_panel_get_item(model, new_x, new_y)) {
+            return new_y * model->reserve_x + new_x;
+        }
+    }
+    return UPGRADED_BUTTON_PANEL_NO_SLOT;
+}
 
-                for(i = 0; i < model->reserve_x; ++i) {
-                    new_selected_item_x = (model->selected_item_x + i) % model->reserve_x;
-                    if(*upgraded_button_panel_get_item(
-                           model, new_selected_item_x, new_selected_item_y)) {
-                        break;
-                    }
-                }
-                if(i != model->reserve_x) {
-                    model->selected_item_x = new_selected_item_x;
-                    model->selected_item_y = new_selected_item_y;
-                }
+static void upgraded_button_panel_build_layout(UpgradedButtonPanelModel* model) {
+    for(size_t y = 0; y < model->reserve_y; ++y) {
+        for(size_t x = 0; x < model->reserve_x; ++x) {
+            uint16_t* neighbours = model->neighbours[y * model->reserve_x + x];
+            for(size_t direction = 0; direction < UpgradedButtonPanelDirectionCount;
+                ++direction) {
+                neighbours[direction] = upgraded_button_panel_scan(model, x, y, direction);
             }
-        },
-        true);
+        }
+    }
+    // rows with buttons go in by their top, usually they are in order already
+    model->row_count = 0;
+    for(size_t y = 0; y < model->reserve_y; ++y) {
+        bool used = false;
+        uint16_t row_top = UINT16_MAX;
+        uint16_t row_bottom = 0;
+        for(size_t x = 0; x < model->reserve_x; ++x) {
+            ButtonItem* button_item = upgraded_button_panel_get_item(model, x, y);
+            if(button_item) {
+                used = true;
+                row_top = MIN(row_top, button_item->icon.y);
+                row_bottom = MAX(
+                    row_bottom,
+                    button_item->icon.y + upgraded_button_panel_item_height(button_item));
+            }
+        }
+        if(!used) {
+            continue;
+        }
+        size_t at = model->row_count++;
+        for(; at > 0 && model->row_bounds[at - 1][0] > row_top; --at) {
+            memcpy(model->row_bounds[at], model->row_bounds[at - 1], sizeof(*model->row_bounds));
+            model->row_order[at] = model->row_order[at - 1];
+        }
+        model->row_bounds[at][0] = row_top;
+        model->row_bounds[at][1] = row_bottom;
+        model->row_order[at] = y;
+    }
+    for(size_t row = 0; row < model->row_count; ++row) {
+        uint16_t reach = row ? model->row_bounds[row - 1][2] : 0;
+        model->row_bounds[row][2] = MAX(reach, model->row_bounds[row][1]);
+    }
+    // the neighbour table is read by moves without layout_mutex once this is seen
+    __atomic_store_n(&model->layout_dirty, false, __ATOMIC_RELEASE);
 }
 
-static void upgraded_button_panel_process_left(UpgradedButtonPanel* upgraded_button_panel) {
+// Scroll position that is just far enough for the button in slot to be on screen
+static uint16_t upgraded_button_panel_scroll_to_slot(
+    UpgradedButtonPanelModel* model,
+    size_t slot,
+    uint16_t scroll_y) {
+    ButtonItem* button_item = upgraded_button_panel_slot_item(model, slot);
+    if(!button_item) {
+        return scroll_y;
+    }
+    uint16_t top = button_item->icon.y;
+    uint16_t bottom = top + upgraded_button_panel_item_height(button_item);
+    if(top < scroll_y) {
+        return top;
+    } else if(bottom > scroll_y + UPGRADED_BUTTON_PANEL_SCREEN_HEIGHT) {
+        return bottom - UPGRADED_BUTTON_PANEL_SCREEN_HEIGHT;
+    }
+    return scroll_y;
+}
+
+// A page keeps moving until the selection is a screen height away from where it was.
+// The layout only changes on this thread, so it is read without layout_mutex
+static void upgraded_button_panel_process_move(
+    UpgradedButtonPanel* upgraded_button_panel,
+    UpgradedButtonPanelDirection direction,
+    bool page) {
     with_view_model(
         upgraded_button_panel->view,
         UpgradedButtonPanelModel * model,
         {
-            size_t new_selected_item_x = model->selected_item_x;
-            size_t new_selected_item_y = model->selected_item_y;
-            size_t i;
-
-            if(new_selected_item_x > 0) {
-                --new_selected_item_x;
-
-                for(i = 0; i < model->reserve_y; ++i) {
-                    new_selected_item_y = (model->selected_item_y + i) % model->reserve_y;
-                    if(*upgraded_button_panel_get_item(
-                           model, new_selected_item_x, new_selected_item_y)) {
-                        break;
+            if(model->reserve_x && model->reserve_y) {
+                if(__atomic_load_n(&model->layout_dirty, __ATOMIC_ACQUIRE)) {
+                    furi_mutex_acquire(model->layout_mutex, FuriWaitForever);
+                    if(model->layout_dirty) {
+                        upgraded_button_panel_build_layout(model);
                     }
+                    furi_mutex_release(model->layout_mutex);
                 }
-                if(i != model->reserve_y) {
-                    model->selected_item_x = new_selected_item_x;
-                    model->selected_item_y = new_selected_item_y;
-                }
+                uint32_t selection = model->selection;
+                size_t slot = UPGRADED_BUTTON_PANEL_SELECTED_SLOT(selection);
+                uint16_t scroll_y = UPGRADED_BUTTON_PANEL_SCROLL_Y(selection);
+                int32_t start = upgraded_button_panel_slot_occupied(model, slot) ?
+                                    model->buttons[slot].icon.y :
+                                    scroll_y;
+                do {
+                    uint16_t next = model->neighbours[slot][direction];
+                    if(next == UPGRADED_BUTTON_PANEL_NO_SLOT) {
+                        break;
+                    }
+                    slot = next;
+                } while(page &&
+                        abs(model->buttons[slot].icon.y - start) <
+                            UPGRADED_BUTTON_PANEL_SCREEN_HEIGHT);
+                scroll_y = upgraded_button_panel_scroll_to_slot(model, slot, scroll_y);
+                __atomic_store_n(
+                    &model->selection,
+                    UPGRADED_BUTTON_PANEL_SELECTION(slot, scroll_y),
+                    __ATOMIC_RELEASE);
             }
         },
         true);
 }
 
-static void upgraded_button_panel_process_right(UpgradedButtonPanel* upgraded_button_panel) {
+void upgraded_button_panel_process_ok(UpgradedButtonPanel* upgraded_button_panel, InputType type) {
+    ButtonItem* button_item = NULL;
+
+    LATENCY_MARK(LatencyTrackPress, LatencyStageInput);
     with_view_model(
         upgraded_button_panel->view,
         UpgradedButtonPanelModel * model,
         {
-            uint16_t new_selected_item_x = model->selected_item_x;
-            uint16_t new_selected_item_y = model->selected_item_y;
-            size_t i;
-
-            if(new_selected_item_x < (model->reserve_x - 1)) {
-                ++new_selected_item_x;
-
-                for(i = 0; i < model->reserve_y; ++i) {
-                    new_selected_item_y = (model->selected_item_y + i) % model->reserve_y;
-                    if(*upgraded_button_panel_get_item(
-                           model, new_selected_item_x, new_selected_item_y)) {
-                        break;
-                    }
-                }
-                if(i != model->reserve_y) {
-                    model->selected_item_x = new_selected_item_x;
-                    model->selected_item_y = new_selected_item_y;
-                }
-            }
+            button_item = upgraded_button_panel_slot_item(
+                model, UPGRADED_BUTTON_PANEL_SELECTED_SLOT(model->selection));
         },
-        true);
+        false);
+    LATENCY_MARK(LatencyTrackPress, LatencyStageProcessOk);
+
+    if(button_item && button_item->callback) {
+        button_item->callback(button_item->callback_context, button_item->index, type);
+    }
 }
 
-void upgraded_button_panel_process_ok(UpgradedButtonPanel* upgraded_button_panel, InputType type) {
+static void upgraded_button_panel_process_select(UpgradedButtonPanel* upgraded_button_panel) {
     ButtonItem* button_item = NULL;
 
     with_view_model(
         upgraded_button_panel->view,
         UpgradedButtonPanelModel * model,
         {
-            button_item = *upgraded_button_panel_get_item(
-                model, model->selected_item_x, model->selected_item_y);
+            button_item = upgraded_button_panel_slot_item(
+                model, UPGRADED_BUTTON_PANEL_SELECTED_SLOT(model->selection));
         },
-        true);
+        false);
 
-    if(button_item && button_item->callback) {
-        button_item->callback(button_item->callback_context, button_item->index, type);
+    if(button_item && button_item != upgraded_button_panel->selected_item) {
+        upgraded_button_panel->selected_item = button_item;
+        if(upgraded_button_panel->select_callback) {
+            upgraded_button_panel->select_callback(
+                upgraded_button_panel->select_context, button_item->index);
+        }
     }
 }
 
@@ -386,6 +688,9 @@ static bool upgraded_button_panel_view_input_callback(InputEvent* event, void* c
     bool consumed = false;
 
     if(event->key == InputKeyOk) {
+        if(event->type == InputTypePress) {
+            LATENCY_BEGIN(LatencyTrackPress);
+        }
         if((event->type == InputTypeRelease) || (event->type == InputTypePress)) {
             consumed = true;
             upgraded_button_panel->freeze = (event->type == InputTypePress);
@@ -395,33 +700,104 @@ static bool upgraded_button_panel_view_input_callback(InputEvent* event, void* c
             upgraded_button_panel_process_ok(upgraded_button_panel, event->type);
         }
     }
+    if(event->key == InputKeyBack && event->type == InputTypeLong &&
+       upgraded_button_panel->back_long_callback) {
+        consumed = true;
+        upgraded_button_panel->back_long_callback(upgraded_button_panel->back_long_context);
+    }
+    // a long press on up or down moves a whole page
+    bool page = (event->type == InputTypeLong);
     if((!upgraded_button_panel->freeze &&
-        ((event->type == InputTypeShort) || (event->type == InputTypeRepeat)))) {
+        ((event->type == InputTypeShort) || (event->type == InputTypeRepeat) || page))) {
         switch(event->key) {
         case InputKeyUp:
             consumed = true;
-            upgraded_button_panel_process_up(upgraded_button_panel);
+            upgraded_button_panel_process_move(
+                upgraded_button_panel, UpgradedButtonPanelDirectionUp, page);
             break;
         case InputKeyDown:
             consumed = true;
-            upgraded_button_panel_process_down(upgraded_button_panel);
+            upgraded_button_panel_process_move(
+                upgraded_button_panel, UpgradedButtonPanelDirectionDown, page);
             break;
         case InputKeyLeft:
-            consumed = true;
-            upgraded_button_panel_process_left(upgraded_button_panel);
+            if(!page) {
+                consumed = true;
+                upgraded_button_panel_process_move(
+                    upgraded_button_panel, UpgradedButtonPanelDirectionLeft, false);
+            }
             break;
         case InputKeyRight:
-            consumed = true;
-            upgraded_button_panel_process_right(upgraded_button_panel);
+            if(!page) {
+                consumed = true;
+                upgraded_button_panel_process_move(
+                    upgraded_button_panel, UpgradedButtonPanelDirectionRight, false);
+            }
             break;
         default:
             break;
         }
+        if(consumed) {
+            upgraded_button_panel_process_select(upgraded_button_panel);
+        }
     }
 
     return consumed;
 }
 
+void upgraded_button_panel_set_selected(
+    UpgradedButtonPanel* upgraded_button_panel,
+    uint16_t matrix_place_x,
+    uint16_t matrix_place_y) {
+    furi_check(upgraded_button_panel);
+    bool selected = false;
+
+    with_view_model(
+        upgraded_button_panel->view,
+        UpgradedButtonPanelModel * model,
+        {
+            if(matrix_place_x < model->reserve_x && matrix_place_y < model->reserve_y) {
+                size_t slot = matrix_place_y * model->reserve_x + matrix_place_x;
+                if(upgraded_button_panel_slot_occupied(model, slot)) {
+                    uint16_t scroll_y = upgraded_button_panel_scroll_to_slot(
+                        model, slot, UPGRADED_BUTTON_PANEL_SCROLL_Y(model->selection));
+                    __atomic_store_n(
+                        &model->selection,
+                        UPGRADED_BUTTON_PANEL_SELECTION(slot, scroll_y),
+                        __ATOMIC_RELEASE);
+                    selected = true;
+                }
+            }
+        },
+        true);
+
+    if(selected) {
+        upgraded_button_panel_process_select(upgraded_button_panel);
+    }
+}
+
+bool upgraded_button_panel_get_selected(
+    UpgradedButtonPanel* upgraded_button_panel,
+    uint16_t* matrix_place_x,
+    uint16_t* matrix_place_y) {
+    furi_check(upgraded_button_panel);
+    bool out = false;
+
+    with_view_model(
+        upgraded_button_panel->view,
+        UpgradedButtonPanelModel * model,
+        {
+            if(model->reserve_x && model->reserve_y) {
+                size_t slot = UPGRADED_BUTTON_PANEL_SELECTED_SLOT(model->selection);
+                *matrix_place_x = slot % model->reserve_x;
+                *matrix_place_y = slot / model->reserve_x;
+                out = true;
+            }
+        },
+        false);
+    return out;
+}
+
 void upgraded_button_panel_add_label(
     UpgradedButtonPanel* upgraded_button_panel,
     uint16_t x,
@@ -434,11 +810,14 @@ void upgraded_button_panel_add_label(
         upgraded_button_panel->view,
         UpgradedButtonPanelModel * model,
         {
+            furi_mutex_acquire(model->layout_mutex, FuriWaitForever);
             LabelElement* label = LabelList_push_raw(model->labels);
             label->x = x;
             label->y = y;
             label->font = font;
             label->str = label_str;
+            model->frame_dirty = true;
+            furi_mutex_release(model->layout_mutex);
         },
         true);
 }
@@ -455,11 +834,14 @@ void upgraded_button_panel_add_icon(
         upgraded_button_panel->view,
         UpgradedButtonPanelModel * model,
         {
+            furi_mutex_acquire(model->layout_mutex, FuriWaitForever);
             IconElement* icon = IconList_push_raw(model->icons);
             icon->x = x;
             icon->y = y;
             icon->name = icon_name;
             icon->name_selected = icon_name;
+            model->frame_dirty = true;
+            furi_mutex_release(model->layout_mutex);
         },
         true);
 }
@@ -1,6 +1,12 @@
 /**
  * @file upgraded_button_panel.h
  * GUI: UpgradedButtonPanel view module API
+ *
+ * Items may be placed below the bottom of the screen, the panel then scrolls to
+ * keep the selected item visible. A long press on up or down moves a page.
+ *
+ * Navigation and OK never wait on drawing, only adding items and resetting the
+ * panel do. Those have to be called from the view dispatcher thread.
  */
 
 #pragma once
@@ -17,6 +23,12 @@ typedef struct UpgradedButtonPanel UpgradedButtonPanel;
 /** Callback type to call for handling selecting upgraded_button_panel items */
 typedef void (*ButtonItemCallback)(void* context, uint32_t index, InputType type);
 
+/** Callback type to call when navigation moves the selection to another item */
+typedef void (*ButtonSelectCallback)(void* context, uint32_t index);
+
+/** Callback type to call when Back is held */
+typedef void (*ButtonBackLongCallback)(void* context);
+
 /** Allocate new upgraded_button_panel module.
  *
  * @return     UpgradedButtonPanel instance
@@ -29,7 +41,8 @@ UpgradedButtonPanel* upgraded_button_panel_alloc(void);
  */
 void upgraded_button_panel_free(UpgradedButtonPanel* upgraded_button_panel);
 
-/** Free items from upgraded_button_panel module. Preallocated matrix stays unchanged.
+/** Free items from upgraded_button_panel module. The grid is released too, reserve again
+ * before adding items.
  *
  * @param      upgraded_button_panel  UpgradedButtonPanel instance
  */
@@ -80,6 +93,74 @@ void upgraded_button_panel_add_item(
     ButtonItemCallback callback,
     void* callback_context);
 
+/** Set callback to call when the selection moves to another item.
+ *
+ * Lets the owner prepare for a press of the newly selected item before OK is
+ * pressed. It is called without holding any lock of the panel.
+ *
+ * @param      upgraded_button_panel  UpgradedButtonPanel instance
+ * @param      callback               function to call with the index of the
+ *                                    newly selected item
+ * @param      context                context to pass to callback
+ */
+void upgraded_button_panel_set_select_callback(
+    UpgradedButtonPanel* upgraded_button_panel,
+    ButtonSelectCallback callback,
+    void* context);
+
+/** Move the selection to an item, scrolling it into view.
+ *
+ * Reports the item to the select callback. Nothing happens if there is no item
+ * at the position.
+ *
+ * @param      upgraded_button_panel  UpgradedButtonPanel instance
+ * @param      matrix_place_x         coordinates by x in the navigation grid
+ * @param      matrix_place_y         coordinates by y in the navigation grid
+ */
+void upgraded_button_panel_set_selected(
+    UpgradedButtonPanel* upgraded_button_panel,
+    uint16_t matrix_place_x,
+    uint16_t matrix_place_y);
+
+/** Get the grid position of the selection.
+ *
+ * @param      upgraded_button_panel  UpgradedButtonPanel instance
+ * @param      matrix_place_x         set to the x coordinate in the navigation grid
+ * @param      matrix_place_y         set to the y coordinate in the navigation grid
+ *
+ * @return     false if nothing was reserved
+ */
+bool upgraded_button_panel_get_selected(
+    UpgradedButtonPanel* upgraded_button_panel,
+    uint16_t* matrix_place_x,
+    uint16_t* matrix_place_y);
+
+/** Set callback to call when Back is held.
+ *
+ * The long press is consumed, a short press of Back still goes to the view
+ * dispatcher. It is called without holding any lock of the panel.
+ *
+ * @param      upgraded_button_panel  UpgradedButtonPanel instance
+ * @param      callback               function to call, NULL to ignore long Back
+ * @param      context                context to pass to callback
+ */
+void upgraded_button_panel_set_back_long_callback(
+    UpgradedButtonPanel* upgraded_button_panel,
+    ButtonBackLongCallback callback,
+    void* context);
+
+/** Draw everything but the selected button once into an off-screen background.
+ *
+ * Every frame then copies the background and draws only the selected button on
+ * top of it. Only for layouts where nothing overlaps the buttons.
+ *
+ * @param      upgraded_button_panel  UpgradedButtonPanel instance
+ * @param      enabled                true to use the static background
+ */
+void upgraded_button_panel_set_static_background(
+    UpgradedButtonPanel* upgraded_button_panel,
+    bool enabled);
+
 /** Get upgraded_button_panel view.
  *
  * @param      upgraded_button_panel  UpgradedButtonPanel instance
@@ -10,11 +10,33 @@
 //my custom button panel to allow type in callback
 #include <extensions/upgraded_button_panel.h>
 
-#include <flipper_format_i.h>
+#include <extensions/latency_probe.h>
 
-#include <infrared_worker.h>
+//loading and sending the signals, kept apart from the GUI
+#include <extensions/ir_remote.h>
+#include <extensions/ir_transmitter.h>
+#include <extensions/ir_loader.h>
+#include <extensions/remote_layout.h>
+#include <extensions/ir_macro.h>
+#include <extensions/remote_cache.h>
 
 #include <notification/notification_messages.h>
+
+#define TAG "FancyRemote"
+
+/*what was open when the app was last closed, it is reopened without the browser. written
+to STATE_TEMP_PATH first, so a cut off write leaves one of the two files whole*/
+#define STATE_PATH      APP_DATA_PATH("state")
+#define STATE_TEMP_PATH APP_DATA_PATH("state.tmp")
+#define STATE_MAGIC     0x46525354
+#define STATE_VERSION   1
+#define STATE_MAX_PATH  256
+
+//bytes the recently used remotes may hold together, the one in use is always kept
+#ifndef FANCY_REMOTE_CACHE_BUDGET
+#define FANCY_REMOTE_CACHE_BUDGET (24 * 1024)
+#endif
+
 typedef enum {
     Scene_RemotePanel,
     Scene_count
@@ -24,177 +46,104 @@ typedef enum {
     FView_UpgradedButtonPanel
 } FView;
 
-typedef enum {
-    Button_VolumeUp,
-    Button_VolumeDown,
-    Button_NavigateLeft,
-    Button_NavigateUp,
-    Button_NavigateRight,
-    Button_NavigateDown,
-    Button_Power,
-    Button_Confirm
-} Button;
-const char* buttonNames[] = {
-    "Volume_up",
-    "Volume_down",
-    "Navigate_left",
-    "Navigate_up",
-    "Navigate_right",
-    "Navigate_down",
-    "Power",
-    "Confirm"};
-typedef struct {
-    uint32_t frequency;
-    float duty_cycle;
-    uint32_t* data;
-    uint32_t size;
-} RawSignal;
-
-typedef struct {
-    bool isRaw;
-    InfraredMessage message;
-    RawSignal raw;
-} Signal;
-
 typedef struct {
     SceneManager* scene_manager;
     ViewDispatcher* view_dispatcher;
     UpgradedButtonPanel* buttonPanel;
-    InfraredWorker* worker;
-    Signal* current;
+    //the .ir file picked in the browser
+    FuriString* path;
+    //recently opened remotes, each with its layout and one preloaded signal per button
+    RemoteCache remotes;
+    //the remote shown, set by loadRemote
+    CachedRemote* current;
+    Transmitter transmitter;
+    //owns transmitter once allocated, every stage, press and release goes through it
+    SignalLoader* loader;
+    MacroRunner* macros;
     NotificationApp* notify;
     DialogsApp* dialogs;
-    FuriString* path;
+    //tick the app started at, 0 once the first panel was shown
+    uint32_t launchTick;
+    //grid cell selected when the panel was last left, restored once when restoreSelection
+    uint16_t selectedX;
+    uint16_t selectedY;
+    bool restoreSelection;
 } FancyRemote;
 
+/*saved state, only the used part of path is written. the parsed signals of the remote
+aren't in here, they come from its sidecar cache which is checked against the .ir file*/
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t pathLength;
+    uint16_t selectedX;
+    uint16_t selectedY;
+    char path[STATE_MAX_PATH];
+} SavedState;
+
 typedef enum {
     Event_ShowRemotePanel,
+    Event_NextRemote,
 } Event;
 
-void clearRawData(Signal* signal) {
-    if(signal->isRaw) {
-        free(signal->raw.data);
-        signal->raw.size = 0;
-        signal->raw.data = NULL;
-    }
-}
-bool makeParsedBody(Signal* signal, FlipperFormat* ff) {
-    FuriString* tmp = furi_string_alloc();
-    bool out = true;
-    if(!flipper_format_read_string(ff, "protocol", tmp)) {
-        out = false;
-    }
-    InfraredMessage message;
-    message.protocol = infrared_get_protocol_by_name(furi_string_get_cstr(tmp));
-    furi_string_free(tmp);
-
-    if(!flipper_format_read_hex(ff, "address", (uint8_t*)&message.address, 4)) {
-        out = false;
-    }
-    if(!flipper_format_read_hex(ff, "command", (uint8_t*)&message.command, 4)) {
-        out = false;
-    }
-    message.repeat = true;
-
-    clearRawData(signal);
-    signal->isRaw = false;
-    signal->message = *&message;
-
-    return out;
-}
-
-bool makeRawBody(Signal* signal, FlipperFormat* ff) {
-    uint32_t frequency;
-    if(!flipper_format_read_uint32(ff, "frequency", &frequency, 1)) {
-        return false;
-    }
-    float duty_cycle;
-    if(!flipper_format_read_float(ff, "duty_cycle", &duty_cycle, 1)) {
-        return false;
-    }
-    uint32_t size;
-    if(!flipper_format_get_value_count(ff, "data", &size)) {
-        return false;
-    }
-    if(size > 1024) {
-        return false;
-    }
-    uint32_t* data = malloc(sizeof(uint32_t) * size);
-    if(!flipper_format_read_uint32(ff, "data", data, size)) {
-        free(data);
-        return false;
-    }
-    clearRawData(signal);
-    signal->isRaw = true;
-    signal->raw.size = size;
-    signal->raw.frequency = frequency;
-    signal->raw.duty_cycle = duty_cycle;
-    signal->raw.data = malloc(sizeof(uint32_t) * size);
-    memcpy(signal->raw.data, data, sizeof(uint32_t) * size);
-    free(data);
-    return true;
+void selectIrSignal(void* context, uint32_t index) {
+    FancyRemote* app = context;
+    loaderStage(app->loader, &app->current->remote, index);
 }
-bool makeBody(Signal* signal, FlipperFormat* ff) {
-    FuriString* tmp = furi_string_alloc();
-    if(!flipper_format_read_string(ff, "type", tmp)) {
-        furi_string_free(tmp);
-        return false;
-    }
-    bool out = false;
-    if(furi_string_equal_str(tmp, "parsed")) {
-        out = makeParsedBody(signal, ff);
-    } else if(furi_string_equal_str(tmp, "raw")) {
-        out = makeRawBody(signal, ff);
-    }
-    furi_string_free(tmp);
-    return out;
+//called from the macro timer, the step is sent by the loader thread
+bool macroStepDue(void* context) {
+    FancyRemote* app = context;
+    return loaderMacroStep(app->loader, app->macros);
 }
-bool makeSignal(void* context, Signal* signal, int index) {
+//called from the loader thread, nothing else transmits while a macro runs
+void sendMacroSignal(void* context, uint32_t signal) {
     FancyRemote* app = context;
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
-    flipper_format_buffered_file_open_existing(ff, furi_string_get_cstr(app->path));
-    FuriString* tmp = furi_string_alloc();
-    while(flipper_format_read_string(ff, "name", tmp)) {
-        if(furi_string_equal_str(tmp, buttonNames[index])) {
-            break;
-        }
-    }
-    furi_string_free(tmp);
-    bool out = makeBody(signal, ff);
-
-    flipper_format_buffered_file_close(ff);
-    flipper_format_free(ff);
-    furi_record_close(RECORD_STORAGE);
-    return out;
+    sendSignalOnce(&app->current->remote, signal);
 }
 void sendIrSignal(void* context, uint32_t index, InputType type) {
     FancyRemote* app = context;
-    if(type == InputTypePress) {
-        if(makeSignal(context, app->current, index)) {
-            infrared_worker_tx_set_get_signal_callback(
-                app->worker, infrared_worker_tx_get_signal_steady_callback, context);
-            bool test = app->current->isRaw;
-            if(test) {
-                infrared_worker_set_raw_signal(
-                    app->worker,
-                    app->current->raw.data,
-                    app->current->raw.size,
-                    app->current->raw.frequency,
-                    app->current->raw.duty_cycle);
-
-            } else {
-                const InfraredMessage message = app->current->message;
-                infrared_worker_set_decoded_signal(app->worker, &message);
-            }
-            notification_message(app->notify, &sequence_blink_start_magenta);
-            infrared_worker_tx_start(app->worker);
+    const RemoteLayout* layout = &app->current->layout;
+    const LayoutButton* button = &layout->buttons[index];
+    if(button->isMacro) {
+        if(type == InputTypePress) {
+            macroStart(app->macros, &layout->steps[button->firstStep], button->stepCount);
+            notification_message(app->notify, &sequence_blink_magenta_10);
+            LATENCY_END(LatencyTrackPress);
         }
+        return;
+    }
+    if(type == InputTypePress) {
+        //any other button cuts a running macro short
+        macroStop(app->macros);
+        loaderPress(app->loader, &app->current->remote, index, &button->repeat);
     } else if(type == InputTypeRelease) {
-        notification_message(app->notify, &sequence_blink_stop);
-        infrared_worker_tx_stop(app->worker);
+        loaderRelease(app->loader);
     }
 }
+//called from the loader thread
+void irSignalStarted(void* context) {
+    FancyRemote* app = context;
+    notification_message(app->notify, &sequence_blink_start_magenta);
+}
+//called from the loader thread after irSignalStarted, so the blink can't outlast TX
+void irSignalStopped(void* context) {
+    FancyRemote* app = context;
+    notification_message(app->notify, &sequence_blink_stop);
+}
+//nothing may point into the remote in use when another one is opened, it could be evicted
+void releaseRemote(FancyRemote* app) {
+    macroStop(app->macros);
+    loaderUnstage(app->loader);
+}
+void loadRemote(FancyRemote* app) {
+    releaseRemote(app);
+    app->current = remoteCacheOpen(&app->remotes, furi_string_get_cstr(app->path));
+}
+//held Back, sent as a custom event so the panel is rebuilt outside its input callback
+void nextRemoteRequested(void* context) {
+    FancyRemote* app = context;
+    view_dispatcher_send_custom_event(app->view_dispatcher, Event_NextRemote);
+}
 //the code to open remotePanel
 //scene_manager_next_scene(app->scene_manager, Scene_RemotePanel);
 
@@ -203,132 +152,58 @@ bool fancy_remote_scene_manager_navigation_event_callback(void* context) {
     return scene_manager_handle_back_event(app->scene_manager);
 }
 
-void addVolumeButtons(void* context, int Vx, int Vy, int x, int y) {
-    /*
-    in origional  volume up is at (38,53), and volume down is at (38,91)
-    so relative measurments are: volUp:(+3,+0),volDown(+3,+20)
-    */
-    FancyRemote* app = context;
-    upgraded_button_panel_add_item(
-        app->buttonPanel,
-        Button_VolumeUp,
-        Vx,
-        Vy,
-        x + 3,
-        y,
-        &I_volup_24x21,
-        &I_volup_hover_24x21,
-        *sendIrSignal,
-        context);
-    upgraded_button_panel_add_item(
-        app->buttonPanel,
-        Button_VolumeDown,
-        Vx,
-        Vy + 1,
-        x + 3,
-        y + 22,
-        &I_voldown_24x21,
-        &I_voldown_hover_24x21,
-        *sendIrSignal,
-        context);
-}
-void addPowerButton(void* context, int Vx, int Vy, int x, int y) {
-    /*in origional the button is at (6,16) and the text is at (4,38)
-    so relative is: button (+2, +0) and text (+0, +22)*/
-    FancyRemote* app = context;
-    upgraded_button_panel_add_item(
-        app->buttonPanel,
-        Button_Power,
-        Vx,
-        Vy,
-        x + 2,
-        y,
-        &I_power_19x20,
-        &I_power_hover_19x20,
-        *sendIrSignal,
-        context);
-}
-void addNavigation(void* context, int Vx, int Vy, int x, int y) {
-    FancyRemote* app = context;
-    /*each button is either 24*18 or 18*24 with the center being 24*24
-        define (+0,+0) as the furthest up and to the left of all
-        navup (+18,+0), navleft (+0,+18), navdown (+18,+42), navright (+42,+18),center (+18,+18);
-        for virtual grid define (+0,+0) as the center
-        navup(+0,-1),navleft(-1,+0),navdown(+0,+1),navright(+1,+0),center(+0,+0);
-        */
-    upgraded_button_panel_add_item(
-        app->buttonPanel,
-        Button_NavigateUp,
-        Vx,
-        Vy - 1,
-        x + 18,
-        y,
-        &I_navup_24x18,
-        &I_navup_hover_24x18,
-        *sendIrSignal,
-        context);
-    upgraded_button_panel_add_item(
-        app->buttonPanel,
-        Button_NavigateLeft,
-        Vx - 1,
-        Vy,
-        x,
-        y + 18,
-        &I_navleft_18x24,
-        &I_navleft_hover_18x24,
-        *sendIrSignal,
-        context);
-    upgraded_button_panel_add_item(
-        app->buttonPanel,
-        Button_NavigateDown,
-        Vx,
-        Vy + 1,
-        x + 18,
-        y + 42,
-        &I_navdown_24x18,
-        &I_navdown_hover_24x18,
-        *sendIrSignal,
-        context);
-    upgraded_button_panel_add_item(
-        app->buttonPanel,
-        Button_NavigateRight,
-        Vx + 1,
-        Vy,
-        x + 42,
-        y + 18,
-        &I_navright_18x24,
-        &I_navright_hover_18x24,
-        *sendIrSignal,
-        context);
-    upgraded_button_panel_add_item(
-        app->buttonPanel,
-        Button_Confirm,
-        Vx,
-        Vy,
-        x + 18,
-        y + 18,
-        &I_navok_24x24,
-        &I_navok_hover_24x24,
-        *sendIrSignal,
-        context);
+void showLayout(FancyRemote* app) {
+    const RemoteLayout* layout = &app->current->layout;
+    upgraded_button_panel_reset(app->buttonPanel);
+    upgraded_button_panel_reserve(app->buttonPanel, layout->gridWidth, layout->gridHeight);
+    for(size_t i = 0; i < layout->count; i++) {
+        const LayoutButton* button = &layout->buttons[i];
+        upgraded_button_panel_add_item(
+            app->buttonPanel,
+            i,
+            button->gridX,
+            button->gridY,
+            button->x,
+            button->y,
+            button->icon,
+            button->iconSelected,
+            *sendIrSignal,
+            app);
+    }
 }
+
 void fancy_remote_scene_on_enter_RemotePanel(void* context) {
     FancyRemote* app = context;
-    upgraded_button_panel_reset(app->buttonPanel);
-    upgraded_button_panel_reserve(app->buttonPanel, 3, 6);
-    /*using 69 puts the bottom of the volume down button at the bottom of the screen
-    (screen height of 128, block height of 59, 128-59=69) */
-    addPowerButton(context, 1, 0, 20, 0);
-    addNavigation(context, 1, 2, 2, 23);
-    addVolumeButtons(context, 1, 4, 16, 85);
-
+    showLayout(app);
+    if(app->restoreSelection) {
+        upgraded_button_panel_set_selected(app->buttonPanel, app->selectedX, app->selectedY);
+        app->restoreSelection = false;
+    }
     view_dispatcher_switch_to_view(app->view_dispatcher, FView_UpgradedButtonPanel);
+    if(app->launchTick) {
+        FURI_LOG_I(TAG, "remote usable %lums after launch", furi_get_tick() - app->launchTick);
+        app->launchTick = 0;
+    }
 }
-bool fancy_remote_scene_on_event_RemotePanel() {
+bool fancy_remote_scene_on_event_RemotePanel(void* context, SceneManagerEvent event) {
+    FancyRemote* app = context;
+    if(event.type == SceneManagerEventTypeCustom && event.event == Event_NextRemote) {
+        //a cached remote, so the switch needs no SD card access
+        CachedRemote* next = remoteCacheNext(&app->remotes, app->current);
+        if(next != app->current) {
+            releaseRemote(app);
+            app->current = next;
+            furi_string_set(app->path, next->remote.path);
+            showLayout(app);
+        }
+        return true;
+    }
     return false;
 }
 void fancy_remote_scene_on_exit_RemotePanel(void* context) {
     FancyRemote* app = context;
+    upgraded_button_panel_get_selected(app->buttonPanel, &app->selectedX, &app->selectedY);
+    releaseRemote(app);
     upgraded_button_panel_reset(app->buttonPanel);
 }
 /*on enter handlers(being declared before use)*/
@@ -363,6 +238,10 @@ void fancy_remote_view_dispatcher_init(FancyRemote* app) {
 
     view_dispatcher_set_navigation_event_callback(
         app->view_dispatcher, fancy_remote_scene_manager_navigation_event_callback);
+    upgraded_button_panel_set_select_callback(app->buttonPanel, selectIrSignal, app);
+    upgraded_button_panel_set_back_long_callback(app->buttonPanel, nextRemoteRequested, app);
+    //nothing is drawn over the buttons, so only the selected one is drawn each frame
+    upgraded_button_panel_set_static_background(app->buttonPanel, true);
     view_dispatcher_add_view(
         app->view_dispatcher,
         FView_UpgradedButtonPanel,
@@ -371,10 +250,17 @@ void fancy_remote_view_dispatcher_init(FancyRemote* app) {
 
 FancyRemote* fancy_remote_init() {
     FancyRemote* app = malloc(sizeof(FancyRemote));
-    app->worker = infrared_worker_alloc();
-    app->current = malloc(sizeof(Signal));
+    app->launchTick = 0;
+    app->selectedX = 0;
+    app->selectedY = 0;
+    app->restoreSelection = false;
+    transmitterInit(&app->transmitter);
+    remoteCacheInit(&app->remotes, FANCY_REMOTE_CACHE_BUDGET);
+    app->current = NULL;
+    app->path = furi_string_alloc_set_str(EXT_PATH("infrared"));
+    app->loader = loaderAlloc(&app->transmitter, irSignalStarted, irSignalStopped, app);
+    app->macros = macroRunnerAlloc(macroStepDue, sendMacroSignal, app);
     app->notify = furi_record_open(RECORD_NOTIFICATION);
-    app->path = furi_string_alloc_set(EXT_PATH("infrared"));
     app->dialogs = furi_record_open(RECORD_DIALOGS);
     fancy_remote_scene_manager_init(app);
     fancy_remote_view_dispatcher_init(app);
@@ -382,37 +268,120 @@ FancyRemote* fancy_remote_init() {
 }
 //frees all data when done
 void fancy_remote_free(FancyRemote* app) {
+    LATENCY_DUMP();
     furi_record_close(RECORD_NOTIFICATION);
     app->notify = NULL;
-    furi_string_free(app->path);
     furi_record_close(RECORD_DIALOGS);
-    infrared_worker_free(app->worker);
+    //steps still queued in the loader do nothing once the macro is stopped
+    macroStop(app->macros);
+    loaderFree(app->loader);
+    macroRunnerFree(app->macros);
+    transmitterFree(&app->transmitter);
+    remoteCacheFree(&app->remotes);
+    furi_string_free(app->path);
     scene_manager_free(app->scene_manager);
     view_dispatcher_remove_view(app->view_dispatcher, FView_UpgradedButtonPanel);
     view_dispatcher_free(app->view_dispatcher);
     upgraded_button_panel_free(app->buttonPanel);
     free(app);
 }
+//reads a whole state file in one go, false if it is missing or broken
+bool readStateFile(Storage* storage, const char* path, SavedState* state) {
+    File* file = storage_file_alloc(storage);
+    size_t size = 0;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        size = storage_file_read(file, state, sizeof(SavedState));
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    return size >= offsetof(SavedState, path) && state->magic == STATE_MAGIC &&
+           state->version == STATE_VERSION && state->pathLength > 0 &&
+           state->pathLength < STATE_MAX_PATH &&
+           size == offsetof(SavedState, path) + state->pathLength;
+}
+//true if the remote open when the app was last closed is still there, app is then set up for it
+bool readState(FancyRemote* app) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    SavedState* state = malloc(sizeof(SavedState));
+    bool found = readStateFile(storage, STATE_PATH, state) ||
+                 readStateFile(storage, STATE_TEMP_PATH, state);
+    if(found) {
+        state->path[state->pathLength] = '\0';
+        found = storage_file_exists(storage, state->path);
+    }
+    if(found) {
+        furi_string_set_str(app->path, state->path);
+        app->selectedX = state->selectedX;
+        app->selectedY = state->selectedY;
+        app->restoreSelection = true;
+    }
+    free(state);
+    furi_record_close(RECORD_STORAGE);
+    return found;
+}
+void writeState(FancyRemote* app) {
+    size_t pathLength = furi_string_size(app->path);
+    if(!pathLength || pathLength >= STATE_MAX_PATH) {
+        return;
+    }
+    SavedState* state = malloc(sizeof(SavedState));
+    state->magic = STATE_MAGIC;
+    state->version = STATE_VERSION;
+    state->pathLength = pathLength;
+    state->selectedX = app->selectedX;
+    state->selectedY = app->selectedY;
+    memcpy(state->path, furi_string_get_cstr(app->path), pathLength);
+    size_t size = offsetof(SavedState, path) + pathLength;
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool written = storage_file_open(file, STATE_TEMP_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+                   storage_file_write(file, state, size) == size;
+    storage_file_close(file);
+    storage_file_free(file);
+    if(written) {
+        storage_common_remove(storage, STATE_PATH);
+        storage_common_rename(storage, STATE_TEMP_PATH, STATE_PATH);
+    }
+    furi_record_close(RECORD_STORAGE);
+    free(state);
+}
 void fancy_remote_select_and_run(FancyRemote* app) {
     DialogsFileBrowserOptions browser_options;
     dialog_file_browser_set_basic_options(&browser_options, ".ir", &I_ir_10px);
     browser_options.base_path = EXT_PATH("infrared");
-    const bool done =
-        dialog_file_browser_show(app->dialogs, app->path, app->path, &browser_options);
-    if(done) {
+    //the last remote comes back right away, its signals are in the sidecar cache
+    bool reopen = readState(app);
+    //back on the panel returns to the browser, the remotes opened so far stay cached
+    while(reopen ||
+          dialog_file_browser_show(app->dialogs, app->path, app->path, &browser_options)) {
+        reopen = false;
+        LATENCY_MARK(LatencyTrackStartup, LatencyStagePick);
+        loadRemote(app);
+        LATENCY_MARK(LatencyTrackStartup, LatencyStageLoadRemote);
+        //the panel is built from the layout of the remote, so it can only be shown now
+        scene_manager_next_scene(app->scene_manager, Scene_RemotePanel);
         view_dispatcher_run(app->view_dispatcher);
     }
+    if(app->current) {
+        writeState(app);
+    }
 }
 
 int32_t fancy_remote_app() {
+    //timed up to the first frame of the panel, see LatencyTrackStartup
+    uint32_t launchTick = furi_get_tick();
+    LATENCY_BEGIN(LatencyTrackStartup);
     FancyRemote* app = fancy_remote_init();
+    app->launchTick = launchTick;
     Gui* gui = furi_record_open(RECORD_GUI);
     view_dispatcher_attach_to_gui(app->view_dispatcher, gui, ViewDispatcherTypeFullscreen);
-    scene_manager_next_scene(app->scene_manager, Scene_RemotePanel);
+    LATENCY_MARK(LatencyTrackStartup, LatencyStageInit);
     fancy_remote_select_and_run(app);
     //this is the main loop
     //view_dispatcher_run(app->view_dispatcher);
     //this runs after program ends
     fancy_remote_free(app);
+    furi_record_close(RECORD_GUI);
     return 0;
 }
@@ -0,0 +1,445 @@
+/*microbenchmarks of the paths a press and a load take, over synthetic remotes of 10 to
+10000 entries. every case checks its result so a fast but broken path doesn't pass.
+--quick only runs the small remotes, that is what ctest does. --memory a.ir b.ir ...
+only reports how small the raw signals of those files are kept*/
+#include <extensions/ir_remote.h>
+#include <extensions/ir_transmitter.h>
+#include <extensions/upgraded_button_panel.h>
+#include <fancy_remote_icons.h>
+#include <gui/canvas_i.h>
+#include <host.h>
+#include <time.h>
+
+#include "synthetic.h"
+
+//not in ir_remote.h, the index is internal to loadSignals
+void clearIndex(IrIndex* index);
+void buildIndex(IrIndex* index, FlipperFormat* ff, FuriString* path);
+void resolveEntries(const IrIndex* index, const SignalNames* names, uint32_t* offsets);
+bool makeBody(Signal* signal, FlipperFormat* ff, Arena* arena, uint32_t* scratch);
+void arenaReset(Arena* arena, size_t size);
+void arenaFree(Arena* arena);
+
+#define BENCH_PATH EXT_PATH("infrared/bench.ir")
+#define BENCH_CACHE_PATH BENCH_PATH ".fancycache"
+#define NO_ENTRY UINT32_MAX
+
+static uint64_t benchNow(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+static void benchReport(const char* name, size_t entries, size_t runs, uint64_t ns) {
+    printf("%-14s %6zu entries %12.0f ns/run\n", name, entries, (double)ns / runs);
+}
+
+static void benchFail(const char* name, size_t entries, const char* what) {
+    fprintf(stderr, "%s with %zu entries: %s\n", name, entries, what);
+    hostStorageCleanup();
+    exit(1);
+}
+
+//names of every entry, so lookup and parse have to fill a signal per entry
+static const char** benchNames(const SyntheticRemote* synthetic) {
+    const char** names = malloc(sizeof(char*) * synthetic->count);
+    FuriString* name = furi_string_alloc();
+    for(size_t i = 0; i < synthetic->count; i++) {
+        syntheticName(synthetic, i, name);
+        names[i] = strdup(furi_string_get_cstr(name));
+    }
+    furi_string_free(name);
+    return names;
+}
+
+static void benchNamesFree(const char** names, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        free((char*)names[i]);
+    }
+    free(names);
+}
+
+//indexes the file and finds the entry of every name
+static void benchLookup(const SyntheticRemote* synthetic, const SignalNames* names, size_t runs) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
+    FuriString* path = furi_string_alloc_set_str(BENCH_PATH);
+    IrIndex index = {.path = furi_string_alloc()};
+    uint32_t* offsets = malloc(sizeof(uint32_t) * names->count);
+    if(!flipper_format_buffered_file_open_existing(ff, BENCH_PATH)) {
+        benchFail("lookup", synthetic->count, "can't open the remote");
+    }
+    uint64_t start = benchNow();
+    for(size_t run = 0; run < runs; run++) {
+        buildIndex(&index, ff, path);
+        resolveEntries(&index, names, offsets);
+    }
+    benchReport("lookup", synthetic->count, runs, benchNow() - start);
+    for(size_t i = 0; i < names->count; i++) {
+        if(offsets[i] == NO_ENTRY) {
+            benchFail("lookup", synthetic->count, "a name wasn't found");
+        }
+    }
+    free(offsets);
+    clearIndex(&index);
+    furi_string_free(index.path);
+    furi_string_free(path);
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static void benchCheckSignals(const char* name, const SyntheticRemote* synthetic, Remote* remote) {
+    for(size_t i = 0; i < remote->count; i++) {
+        const Signal* signal = &remote->signals[i];
+        if(!signal->isValid || signal->isRaw != syntheticIsRaw(synthetic, i)) {
+            benchFail(name, synthetic->count, "a signal was loaded wrong");
+        }
+        if(!signal->isRaw && signal->message.command != (i & 0xFF)) {
+            benchFail(name, synthetic->count, "a parsed signal has the wrong command");
+        }
+    }
+}
+
+//loads every signal from the .ir file, then from the sidecar cache the first load wrote
+static void benchParse(const SyntheticRemote* synthetic, const SignalNames* names, size_t runs) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, BENCH_PATH);
+    uint64_t elapsed = 0;
+    for(size_t run = 0; run < runs; run++) {
+        storage_common_remove(storage, BENCH_CACHE_PATH);
+        uint64_t start = benchNow();
+        loadSignals(&remote, names);
+        elapsed += benchNow() - start;
+    }
+    benchReport("parse", synthetic->count, runs, elapsed);
+    benchCheckSignals("parse", synthetic, &remote);
+
+    uint64_t start = benchNow();
+    for(size_t run = 0; run < runs; run++) {
+        loadSignals(&remote, names);
+    }
+    benchReport("parse cached", synthetic->count, runs, benchNow() - start);
+    benchCheckSignals("parse cached", synthetic, &remote);
+    remoteFree(&remote);
+    furi_record_close(RECORD_STORAGE);
+}
+
+//the press path before signals were preloaded, the file was opened and scanned every press
+static bool
+    benchLegacyMakeSignal(const char* name, Signal* signal, Arena* arena, uint32_t* scratch) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    FlipperFormat* ff = flipper_format_buffered_file_alloc(storage);
+    flipper_format_buffered_file_open_existing(ff, BENCH_PATH);
+    FuriString* tmp = furi_string_alloc();
+    while(flipper_format_read_string(ff, "name", tmp)) {
+        if(furi_string_equal_str(tmp, name)) {
+            break;
+        }
+    }
+    furi_string_free(tmp);
+    arenaReset(arena, sizeof(uint16_t) * RAW_MAX_TIMINGS);
+    memset(signal, 0, sizeof(Signal));
+    bool out = makeBody(signal, ff, arena, scratch);
+    flipper_format_buffered_file_close(ff);
+    flipper_format_free(ff);
+    furi_record_close(RECORD_STORAGE);
+    return out;
+}
+
+static InfraredWorkerGetSignalResponse benchLegacyCallback(void* context, InfraredWorker* worker) {
+    UNUSED(context);
+    UNUSED(worker);
+    return InfraredWorkerGetSignalResponseNew;
+}
+
+//presses every button of the built-in layout and sends its first frame
+static void benchPress(const SyntheticRemote* synthetic, size_t runs) {
+    InfraredWorker* worker = infrared_worker_alloc();
+    infrared_worker_tx_set_get_signal_callback(worker, benchLegacyCallback, NULL);
+    Arena arena = {0};
+    uint32_t* scratch = malloc(sizeof(uint32_t) * RAW_MAX_TIMINGS);
+    Signal signal;
+    uint64_t start = benchNow();
+    for(size_t run = 0; run < runs; run++) {
+        for(size_t i = 0; i < SYNTHETIC_LAYOUT_COUNT; i++) {
+            if(!benchLegacyMakeSignal(syntheticLayoutNames[i], &signal, &arena, scratch)) {
+                benchFail("press before", synthetic->count, "a signal wasn't found");
+            }
+            if(signal.isRaw) {
+                expandRawSignal(&signal.raw, scratch);
+                infrared_worker_set_raw_signal(
+                    worker,
+                    scratch,
+                    signal.raw.size,
+                    signal.raw.frequency,
+                    signal.raw.duty_cycle);
+            } else {
+                infrared_worker_set_decoded_signal(worker, &signal.message);
+            }
+            infrared_worker_tx_start(worker);
+            hostWorkerRun(worker, 1);
+            infrared_worker_tx_stop(worker);
+            hostWorkerClearFrames(worker);
+        }
+    }
+    size_t presses = runs * SYNTHETIC_LAYOUT_COUNT;
+    benchReport("press before", synthetic->count, presses, benchNow() - start);
+    arenaFree(&arena);
+    free(scratch);
+    infrared_worker_free(worker);
+
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, BENCH_PATH);
+    SignalNames names = {.names = syntheticLayoutNames, .count = SYNTHETIC_LAYOUT_COUNT};
+    loadSignals(&remote, &names);
+    Transmitter transmitter;
+    transmitterInit(&transmitter);
+    const RepeatPolicy policy = {0};
+    start = benchNow();
+    for(size_t run = 0; run < runs; run++) {
+        for(uint32_t i = 0; i < SYNTHETIC_LAYOUT_COUNT; i++) {
+            //focus stages the signal ahead of the press, as the panel does
+            stageSignal(&transmitter, &remote, i);
+            if(!startSignal(&transmitter, &remote, i, &policy) ||
+               hostWorkerRun(transmitter.worker, 1) != 1) {
+                benchFail("press after", synthetic->count, "a signal wasn't sent");
+            }
+            stopSignal(&transmitter);
+            hostWorkerClearFrames(transmitter.worker);
+        }
+    }
+    benchReport("press after", synthetic->count, presses, benchNow() - start);
+    transmitterFree(&transmitter);
+    remoteFree(&remote);
+}
+
+#define BENCH_COLUMNS 4
+#define BENCH_ROW_HEIGHT 12
+
+//one 10px button per entry, four to a row
+static UpgradedButtonPanel* benchPanel(size_t count) {
+    UpgradedButtonPanel* panel = upgraded_button_panel_alloc();
+    size_t rows = (count + BENCH_COLUMNS - 1) / BENCH_COLUMNS;
+    upgraded_button_panel_reserve(panel, BENCH_COLUMNS, rows);
+    for(size_t i = 0; i < count; i++) {
+        uint16_t column = i % BENCH_COLUMNS;
+        uint16_t row = i / BENCH_COLUMNS;
+        upgraded_button_panel_add_item(
+            panel,
+            i,
+            column,
+            row,
+            2 + column * 16,
+            row * BENCH_ROW_HEIGHT,
+            &I_ir_10px,
+            &I_ir_10px,
+            NULL,
+            NULL);
+    }
+    return panel;
+}
+
+//walks down to the last row and back up, one step per input
+static void benchNavigate(size_t count) {
+    UpgradedButtonPanel* panel = benchPanel(count);
+    View* view = upgraded_button_panel_get_view(panel);
+    size_t rows = (count + BENCH_COLUMNS - 1) / BENCH_COLUMNS;
+    uint16_t x, y;
+    uint64_t start = benchNow();
+    for(size_t i = 1; i < rows; i++) {
+        hostViewInput(view, InputKeyDown, InputTypeShort);
+    }
+    upgraded_button_panel_get_selected(panel, &x, &y);
+    if(y != rows - 1) {
+        benchFail("navigate", count, "down didn't reach the last row");
+    }
+    for(size_t i = 1; i < rows; i++) {
+        hostViewInput(view, InputKeyUp, InputTypeShort);
+    }
+    benchReport("navigate", count, rows > 1 ? 2 * (rows - 1) : 1, benchNow() - start);
+    upgraded_button_panel_get_selected(panel, &x, &y);
+    if(y != 0) {
+        benchFail("navigate", count, "up didn't reach the first row");
+    }
+    upgraded_button_panel_free(panel);
+}
+
+//draws frames at the top, the middle and the bottom of the panel
+static void benchDraw(size_t count, size_t runs) {
+    UpgradedButtonPanel* panel = benchPanel(count);
+    View* view = upgraded_button_panel_get_view(panel);
+    Canvas* canvas = hostCanvasAlloc();
+    size_t rows = (count + BENCH_COLUMNS - 1) / BENCH_COLUMNS;
+    const uint16_t at[] = {0, rows / 2, rows - 1};
+    uint64_t elapsed = 0;
+    for(size_t i = 0; i < COUNT_OF(at); i++) {
+        upgraded_button_panel_set_selected(panel, 0, at[i]);
+        uint64_t start = benchNow();
+        for(size_t run = 0; run < runs; run++) {
+            hostViewDraw(view, canvas);
+        }
+        elapsed += benchNow() - start;
+    }
+    benchReport("draw", count, runs * COUNT_OF(at), elapsed);
+    if(hostCanvasCalls(canvas).icon == 0) {
+        benchFail("draw", count, "nothing was drawn");
+    }
+    hostCanvasFree(canvas);
+    upgraded_button_panel_free(panel);
+}
+
+static uint32_t benchDrawCalls(View* view, Canvas* canvas) {
+    canvas_clear(canvas);
+    hostCanvasResetCalls(canvas);
+    hostViewDraw(view, canvas);
+    HostCanvasCalls calls = hostCanvasCalls(canvas);
+    return calls.clear + calls.icon + calls.box + calls.str;
+}
+
+/*canvas calls of a frame drawn in full, which every frame used to be, of one after the
+selection moved to the next button and of one where nothing changed*/
+static void benchDrawFrames(size_t count) {
+    UpgradedButtonPanel* panel = benchPanel(count);
+    View* view = upgraded_button_panel_get_view(panel);
+    Canvas* canvas = hostCanvasAlloc();
+    uint32_t full = benchDrawCalls(view, canvas);
+    hostViewInput(view, InputKeyRight, InputTypeShort);
+    uint32_t move = benchDrawCalls(view, canvas);
+    uint32_t still = benchDrawCalls(view, canvas);
+    printf(
+        "%-14s %6zu entries %6lu full %6lu move %6lu still calls/frame\n",
+        "draw calls",
+        count,
+        full,
+        move,
+        still);
+    if(move >= full) {
+        benchFail("draw calls", count, "a move redrew everything");
+    }
+    hostCanvasFree(canvas);
+    upgraded_button_panel_free(panel);
+}
+
+//bytes the timings of the raw signals kept in memory take, against a 32 bit word per timing
+static void benchMemoryReport(const char* name, const Remote* remote) {
+    size_t signals = 0, timings = 0, bytes = 0;
+    for(size_t i = 0; i < remote->count; i++) {
+        const Signal* signal = &remote->signals[i];
+        if(signal->isValid && signal->isRaw && !signal->isStreamed) {
+            const RawSignal* raw = &signal->raw;
+            signals++;
+            timings += raw->size;
+            bytes += raw->codes ? sizeof(uint16_t) * raw->dictSize + (raw->size + 1) / 2 :
+                                  sizeof(uint16_t) * raw->size;
+        }
+    }
+    printf(
+        "%-24s %4zu raw %7zu timings %8zu -> %7zu bytes, %3.0f%%\n",
+        name,
+        signals,
+        timings,
+        sizeof(uint32_t) * timings,
+        bytes,
+        timings ? 100.0 * bytes / (sizeof(uint32_t) * timings) : 0);
+}
+
+static void benchMemory(const char* name, const SignalNames* names) {
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, BENCH_PATH);
+    loadSignals(&remote, names);
+    benchMemoryReport(name, &remote);
+    remoteFree(&remote);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_remove(storage, BENCH_CACHE_PATH);
+    furi_record_close(RECORD_STORAGE);
+}
+
+//synthetic captures with more and more jitter
+static void benchMemorySynthetic(void) {
+    const uint32_t jitters[] = {0, 50, 100};
+    for(size_t i = 0; i < COUNT_OF(jitters); i++) {
+        SyntheticRemote synthetic = {
+            .count = SYNTHETIC_LAYOUT_COUNT, .rawEvery = 1, .rawSize = 300, .jitter = jitters[i]};
+        if(!syntheticWrite(BENCH_PATH, &synthetic)) {
+            benchFail("memory", synthetic.count, "can't write the remote");
+        }
+        SignalNames names = {.names = syntheticLayoutNames, .count = SYNTHETIC_LAYOUT_COUNT};
+        char name[32];
+        snprintf(name, sizeof(name), "memory jitter %luus", jitters[i]);
+        benchMemory(name, &names);
+    }
+}
+
+//a .ir file from anywhere on the PC, every entry of it is loaded
+static bool benchMemoryFile(const char* path) {
+    FILE* in = fopen(path, "r");
+    FILE* out = fopen(hostStoragePath(BENCH_PATH), "w");
+    if(!in || !out) {
+        if(in) {
+            fclose(in);
+        }
+        if(out) {
+            fclose(out);
+        }
+        return false;
+    }
+    const char** names = NULL;
+    size_t count = 0;
+    char* line = NULL;
+    size_t capacity = 0;
+    while(getline(&line, &capacity, in) != -1) {
+        fputs(line, out);
+        if(strncmp(line, "name: ", strlen("name: ")) == 0) {
+            line[strcspn(line, "\r\n")] = '\0';
+            names = realloc(names, sizeof(char*) * (count + 1));
+            names[count++] = strdup(line + strlen("name: "));
+        }
+    }
+    free(line);
+    fclose(in);
+    fclose(out);
+    SignalNames signalNames = {.names = names, .count = count};
+    const char* slash = strrchr(path, '/');
+    benchMemory(slash ? slash + 1 : path, &signalNames);
+    benchNamesFree(names, count);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    bool quick = argc > 1 && strcmp(argv[1], "--quick") == 0;
+    const size_t sizes[] = {10, 100, 1000, 10000};
+    size_t count = quick ? 2 : COUNT_OF(sizes);
+    hostStorageInit();
+    if(argc > 1 && strcmp(argv[1], "--memory") == 0) {
+        for(int i = 2; i < argc; i++) {
+            if(!benchMemoryFile(argv[i])) {
+                fprintf(stderr, "can't read %s\n", argv[i]);
+            }
+        }
+        hostStorageCleanup();
+        return 0;
+    }
+    benchMemorySynthetic();
+    for(size_t i = 0; i < count; i++) {
+        SyntheticRemote synthetic = {.count = sizes[i], .rawEvery = 4, .rawSize = 99};
+        if(!syntheticWrite(BENCH_PATH, &synthetic)) {
+            benchFail("setup", sizes[i], "can't write the remote");
+        }
+        const char** names = benchNames(&synthetic);
+        SignalNames signalNames = {.names = names, .count = synthetic.count};
+        size_t runs = MAX((size_t)1, 10000 / sizes[i]);
+        benchLookup(&synthetic, &signalNames, runs);
+        benchParse(&synthetic, &signalNames, runs);
+        benchPress(&synthetic, runs);
+        benchNavigate(sizes[i]);
+        benchDraw(sizes[i], 100);
+        benchDrawFrames(sizes[i]);
+        benchNamesFree(names, synthetic.count);
+    }
+    hostStorageCleanup();
+    return 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <gui/icon.h>
+
+/* fbt generates this from the images folder, the host only knows the sizes */
+extern const Icon I_ir_10px;
+extern const Icon I_navdown_24x18;
+extern const Icon I_navdown_hover_24x18;
+extern const Icon I_navleft_18x24;
+extern const Icon I_navleft_hover_18x24;
+extern const Icon I_navok_24x24;
+extern const Icon I_navok_hover_24x24;
+extern const Icon I_navright_18x24;
+extern const Icon I_navright_hover_18x24;
+extern const Icon I_navup_24x18;
+extern const Icon I_navup_hover_24x18;
+extern const Icon I_power_19x20;
+extern const Icon I_power_hover_19x20;
+extern const Icon I_power_text_24x5;
+extern const Icon I_vol_tv_text_29x34;
+extern const Icon I_voldown_24x21;
+extern const Icon I_voldown_hover_24x21;
+extern const Icon I_volup_24x21;
+extern const Icon I_volup_hover_24x21;
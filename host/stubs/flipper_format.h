@@ -0,0 +1,50 @@
+/**
+ * @file flipper_format.h
+ * Host FlipperFormat over a file, keys are searched from the current position on
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <storage/storage.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct FlipperFormat FlipperFormat;
+
+FlipperFormat* flipper_format_buffered_file_alloc(Storage* storage);
+bool flipper_format_buffered_file_open_existing(FlipperFormat* flipper_format, const char* path);
+bool flipper_format_buffered_file_close(FlipperFormat* flipper_format);
+void flipper_format_free(FlipperFormat* flipper_format);
+
+bool flipper_format_rewind(FlipperFormat* flipper_format);
+bool flipper_format_read_header(
+    FlipperFormat* flipper_format,
+    FuriString* filetype,
+    uint32_t* version);
+bool flipper_format_read_string(FlipperFormat* flipper_format, const char* key, FuriString* data);
+bool flipper_format_read_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint8_t* data,
+    const uint16_t data_size);
+bool flipper_format_read_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* data,
+    const uint16_t data_size);
+bool flipper_format_read_float(
+    FlipperFormat* flipper_format,
+    const char* key,
+    float* data,
+    const uint16_t data_size);
+bool flipper_format_get_value_count(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* count);
+
+#ifdef __cplusplus
+}
+#endif
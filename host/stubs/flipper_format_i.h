@@ -0,0 +1,14 @@
+#pragma once
+
+#include <flipper_format.h>
+#include <toolbox/stream/stream.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+Stream* flipper_format_get_raw_stream(FlipperFormat* flipper_format);
+
+#ifdef __cplusplus
+}
+#endif
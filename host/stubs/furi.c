@@ -0,0 +1,555 @@
+#include <furi.h>
+#include <furi_hal.h>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "host.h"
+
+void furi_host_crash(const char* message, const char* file, int line) {
+    fprintf(stderr, "furi_crash: %s at %s:%d\n", message, file, line);
+    abort();
+}
+
+static size_t log_counts[256];
+
+void furi_log_print(char level, const char* tag, const char* format, ...) {
+    __atomic_add_fetch(&log_counts[(uint8_t)level], 1, __ATOMIC_RELAXED);
+    if(level == 'D' && !getenv("FANCY_REMOTE_HOST_DEBUG")) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    fprintf(stderr, "[%c][%s] ", level, tag);
+    vfprintf(stderr, format, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+size_t hostLogCount(char level) {
+    return __atomic_load_n(&log_counts[(uint8_t)level], __ATOMIC_RELAXED);
+}
+
+/* strings */
+
+struct FuriString {
+    char* data;
+    size_t size;
+    size_t capacity;
+};
+
+static void furi_string_reserve(FuriString* string, size_t size) {
+    if(size + 1 > string->capacity) {
+        string->capacity = MAX(size + 1, string->capacity * 2);
+        string->data = realloc(string->data, string->capacity);
+    }
+}
+
+FuriString* furi_string_alloc(void) {
+    FuriString* string = malloc(sizeof(FuriString));
+    string->capacity = 16;
+    string->data = malloc(string->capacity);
+    string->data[0] = '\0';
+    string->size = 0;
+    return string;
+}
+
+FuriString* furi_string_alloc_set(const FuriString* source) {
+    FuriString* string = furi_string_alloc();
+    furi_string_set(string, source);
+    return string;
+}
+
+FuriString* furi_string_alloc_set_str(const char* cstr) {
+    FuriString* string = furi_string_alloc();
+    furi_string_set_str(string, cstr);
+    return string;
+}
+
+static int furi_string_vprintf(FuriString* string, const char* format, va_list args) {
+    va_list copy;
+    va_copy(copy, args);
+    int size = vsnprintf(NULL, 0, format, copy);
+    va_end(copy);
+    furi_string_reserve(string, size);
+    vsnprintf(string->data, size + 1, format, args);
+    string->size = size;
+    return size;
+}
+
+FuriString* furi_string_alloc_printf(const char* format, ...) {
+    FuriString* string = furi_string_alloc();
+    va_list args;
+    va_start(args, format);
+    furi_string_vprintf(string, format, args);
+    va_end(args);
+    return string;
+}
+
+int furi_string_printf(FuriString* string, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    int size = furi_string_vprintf(string, format, args);
+    va_end(args);
+    return size;
+}
+
+void furi_string_free(FuriString* string) {
+    free(string->data);
+    free(string);
+}
+
+void furi_string_reset(FuriString* string) {
+    string->size = 0;
+    string->data[0] = '\0';
+}
+
+void furi_string_set(FuriString* string, const FuriString* source) {
+    furi_string_set_strn(string, source->data, source->size);
+}
+
+void furi_string_set_str(FuriString* string, const char* cstr) {
+    furi_string_set_strn(string, cstr, strlen(cstr));
+}
+
+void furi_string_set_strn(FuriString* string, const char* cstr, size_t n) {
+    furi_string_reserve(string, n);
+    memmove(string->data, cstr, n);
+    string->data[n] = '\0';
+    string->size = n;
+}
+
+void furi_string_push_back(FuriString* string, char c) {
+    furi_string_reserve(string, string->size + 1);
+    string->data[string->size++] = c;
+    string->data[string->size] = '\0';
+}
+
+void furi_string_cat_str(FuriString* string, const char* cstr) {
+    size_t n = strlen(cstr);
+    furi_string_reserve(string, string->size + n);
+    memcpy(string->data + string->size, cstr, n + 1);
+    string->size += n;
+}
+
+const char* furi_string_get_cstr(const FuriString* string) {
+    return string->data;
+}
+
+size_t furi_string_size(const FuriString* string) {
+    return string->size;
+}
+
+bool furi_string_empty(const FuriString* string) {
+    return string->size == 0;
+}
+
+bool furi_string_equal(const FuriString* string, const FuriString* other) {
+    return string->size == other->size && memcmp(string->data, other->data, string->size) == 0;
+}
+
+bool furi_string_equal_str(const FuriString* string, const char* cstr) {
+    return strcmp(string->data, cstr) == 0;
+}
+
+bool furi_string_start_with_str(const FuriString* string, const char* start) {
+    return strncmp(string->data, start, strlen(start)) == 0;
+}
+
+size_t furi_string_search_rchar(const FuriString* string, char c, size_t start) {
+    for(size_t i = string->size; i > start; i--) {
+        if(string->data[i - 1] == c) {
+            return i - 1;
+        }
+    }
+    return FURI_STRING_FAILURE;
+}
+
+void furi_string_left(FuriString* string, size_t index) {
+    if(index < string->size) {
+        string->size = index;
+        string->data[index] = '\0';
+    }
+}
+
+/* records, every name is its own opaque object */
+
+static char records[8][1];
+static const char* record_names[COUNT_OF(records)];
+static pthread_mutex_t record_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void* furi_record_open(const char* name) {
+    pthread_mutex_lock(&record_lock);
+    size_t i = 0;
+    while(i < COUNT_OF(records) && record_names[i] && strcmp(record_names[i], name) != 0) {
+        i++;
+    }
+    furi_check(i < COUNT_OF(records));
+    record_names[i] = name;
+    pthread_mutex_unlock(&record_lock);
+    return records[i];
+}
+
+void furi_record_close(const char* name) {
+    UNUSED(name);
+}
+
+/* fake clock and timers */
+
+struct FuriTimer {
+    FuriTimerCallback callback;
+    void* context;
+    FuriTimerType type;
+    bool active;
+    uint64_t deadline;
+    uint32_t period;
+    FuriTimer* next;
+};
+
+static pthread_mutex_t clock_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t clock_now;
+static FuriTimer* timers;
+
+static DWT_Type host_dwt;
+DWT_Type* DWT = &host_dwt;
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void) {
+    return 64;
+}
+
+uint64_t hostClockNow(void) {
+    pthread_mutex_lock(&clock_lock);
+    uint64_t now = clock_now;
+    pthread_mutex_unlock(&clock_lock);
+    return now;
+}
+
+void hostClockAdvance(uint64_t us) {
+    pthread_mutex_lock(&clock_lock);
+    uint64_t target = clock_now + us;
+    while(true) {
+        FuriTimer* due = NULL;
+        for(FuriTimer* timer = timers; timer; timer = timer->next) {
+            if(timer->active && timer->deadline <= target &&
+               (!due || timer->deadline < due->deadline)) {
+                due = timer;
+            }
+        }
+        if(!due) {
+            break;
+        }
+        clock_now = MAX(clock_now, due->deadline);
+        if(due->type == FuriTimerTypePeriodic) {
+            due->deadline += (uint64_t)due->period * 1000;
+        } else {
+            due->active = false;
+        }
+        pthread_mutex_unlock(&clock_lock);
+        due->callback(due->context);
+        pthread_mutex_lock(&clock_lock);
+    }
+    clock_now = target;
+    pthread_mutex_unlock(&clock_lock);
+}
+
+uint32_t furi_get_tick(void) {
+    return hostClockNow() / 1000;
+}
+
+uint32_t furi_ms_to_ticks(uint32_t milliseconds) {
+    return milliseconds;
+}
+
+//time spent waiting is time the infrared hardware goes on sending, the fake clock stays
+void furi_delay_ms(uint32_t milliseconds) {
+    hostInfraredRun((uint64_t)milliseconds * 1000);
+    sched_yield();
+}
+
+FuriTimer* furi_timer_alloc(FuriTimerCallback func, FuriTimerType type, void* context) {
+    FuriTimer* timer = calloc(1, sizeof(FuriTimer));
+    timer->callback = func;
+    timer->context = context;
+    timer->type = type;
+    pthread_mutex_lock(&clock_lock);
+    timer->next = timers;
+    timers = timer;
+    pthread_mutex_unlock(&clock_lock);
+    return timer;
+}
+
+void furi_timer_free(FuriTimer* timer) {
+    pthread_mutex_lock(&clock_lock);
+    FuriTimer** link = &timers;
+    while(*link != timer) {
+        link = &(*link)->next;
+    }
+    *link = timer->next;
+    pthread_mutex_unlock(&clock_lock);
+    free(timer);
+}
+
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks) {
+    pthread_mutex_lock(&clock_lock);
+    timer->deadline = clock_now + (uint64_t)ticks * 1000;
+    timer->period = ticks;
+    timer->active = true;
+    pthread_mutex_unlock(&clock_lock);
+    return FuriStatusOk;
+}
+
+FuriStatus furi_timer_stop(FuriTimer* timer) {
+    pthread_mutex_lock(&clock_lock);
+    timer->active = false;
+    pthread_mutex_unlock(&clock_lock);
+    return FuriStatusOk;
+}
+
+uint32_t furi_timer_is_running(FuriTimer* timer) {
+    pthread_mutex_lock(&clock_lock);
+    bool active = timer->active;
+    pthread_mutex_unlock(&clock_lock);
+    return active;
+}
+
+/* timeouts of everything that blocks are real milliseconds */
+
+static struct timespec deadline_after(uint32_t timeout) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout / 1000;
+    deadline.tv_nsec += (long)(timeout % 1000) * 1000000;
+    if(deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+    }
+    return deadline;
+}
+
+//waits on condition, false once timeout ran out
+static bool wait_for(pthread_cond_t* condition, pthread_mutex_t* lock, uint32_t timeout) {
+    if(timeout == 0) {
+        return false;
+    }
+    if(timeout == FuriWaitForever) {
+        pthread_cond_wait(condition, lock);
+        return true;
+    }
+    struct timespec deadline = deadline_after(timeout);
+    return pthread_cond_timedwait(condition, lock, &deadline) != ETIMEDOUT;
+}
+
+/* threads */
+
+struct FuriThread {
+    pthread_t thread;
+    FuriThreadCallback callback;
+    void* context;
+    bool started;
+};
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context) {
+    UNUSED(name);
+    UNUSED(stack_size);
+    FuriThread* thread = calloc(1, sizeof(FuriThread));
+    thread->callback = callback;
+    thread->context = context;
+    return thread;
+}
+
+void furi_thread_free(FuriThread* thread) {
+    free(thread);
+}
+
+void furi_thread_set_priority(FuriThread* thread, FuriThreadPriority priority) {
+    UNUSED(thread);
+    UNUSED(priority);
+}
+
+static void* furi_thread_body(void* context) {
+    FuriThread* thread = context;
+    thread->callback(thread->context);
+    return NULL;
+}
+
+void furi_thread_start(FuriThread* thread) {
+    furi_check(pthread_create(&thread->thread, NULL, furi_thread_body, thread) == 0);
+    thread->started = true;
+}
+
+bool furi_thread_join(FuriThread* thread) {
+    if(thread->started) {
+        pthread_join(thread->thread, NULL);
+        thread->started = false;
+    }
+    return true;
+}
+
+/* message queues */
+
+struct FuriMessageQueue {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint8_t* buffer;
+    uint32_t capacity;
+    uint32_t size;
+    uint32_t head;
+    uint32_t count;
+};
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size) {
+    FuriMessageQueue* queue = calloc(1, sizeof(FuriMessageQueue));
+    pthread_mutex_init(&queue->lock, NULL);
+    pthread_cond_init(&queue->changed, NULL);
+    queue->buffer = malloc((size_t)msg_count * msg_size);
+    queue->capacity = msg_count;
+    queue->size = msg_size;
+    return queue;
+}
+
+void furi_message_queue_free(FuriMessageQueue* queue) {
+    pthread_cond_destroy(&queue->changed);
+    pthread_mutex_destroy(&queue->lock);
+    free(queue->buffer);
+    free(queue);
+}
+
+FuriStatus furi_message_queue_put(FuriMessageQueue* queue, const void* msg, uint32_t timeout) {
+    FuriStatus status = FuriStatusOk;
+    pthread_mutex_lock(&queue->lock);
+    while(queue->count == queue->capacity) {
+        if(!wait_for(&queue->changed, &queue->lock, timeout)) {
+            status = FuriStatusErrorTimeout;
+            break;
+        }
+    }
+    if(status == FuriStatusOk) {
+        uint32_t tail = (queue->head + queue->count) % queue->capacity;
+        memcpy(queue->buffer + (size_t)tail * queue->size, msg, queue->size);
+        queue->count++;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return status;
+}
+
+FuriStatus furi_message_queue_get(FuriMessageQueue* queue, void* msg, uint32_t timeout) {
+    FuriStatus status = FuriStatusOk;
+    pthread_mutex_lock(&queue->lock);
+    while(queue->count == 0) {
+        if(!wait_for(&queue->changed, &queue->lock, timeout)) {
+            status = FuriStatusErrorTimeout;
+            break;
+        }
+    }
+    if(status == FuriStatusOk) {
+        memcpy(msg, queue->buffer + (size_t)queue->head * queue->size, queue->size);
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+        pthread_cond_broadcast(&queue->changed);
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return status;
+}
+
+/* mutexes */
+
+struct FuriMutex {
+    pthread_mutex_t mutex;
+};
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type) {
+    FuriMutex* mutex = malloc(sizeof(FuriMutex));
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_settype(
+        &attributes,
+        type == FuriMutexTypeRecursive ? PTHREAD_MUTEX_RECURSIVE : PTHREAD_MUTEX_ERRORCHECK);
+    pthread_mutex_init(&mutex->mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    return mutex;
+}
+
+void furi_mutex_free(FuriMutex* mutex) {
+    pthread_mutex_destroy(&mutex->mutex);
+    free(mutex);
+}
+
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout) {
+    int result;
+    if(timeout == FuriWaitForever) {
+        result = pthread_mutex_lock(&mutex->mutex);
+    } else if(timeout == 0) {
+        result = pthread_mutex_trylock(&mutex->mutex);
+    } else {
+        struct timespec deadline = deadline_after(timeout);
+        result = pthread_mutex_timedlock(&mutex->mutex, &deadline);
+    }
+    //a normal mutex locked twice by one thread deadlocks on the device
+    furi_check(result != EDEADLK);
+    return result == 0 ? FuriStatusOk : FuriStatusErrorTimeout;
+}
+
+FuriStatus furi_mutex_release(FuriMutex* mutex) {
+    furi_check(pthread_mutex_unlock(&mutex->mutex) == 0);
+    return FuriStatusOk;
+}
+
+/* semaphores */
+
+struct FuriSemaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    uint32_t count;
+    uint32_t max;
+};
+
+FuriSemaphore* furi_semaphore_alloc(uint32_t max_count, uint32_t initial_count) {
+    FuriSemaphore* semaphore = calloc(1, sizeof(FuriSemaphore));
+    pthread_mutex_init(&semaphore->lock, NULL);
+    pthread_cond_init(&semaphore->changed, NULL);
+    semaphore->count = initial_count;
+    semaphore->max = max_count;
+    return semaphore;
+}
+
+void furi_semaphore_free(FuriSemaphore* semaphore) {
+    pthread_cond_destroy(&semaphore->changed);
+    pthread_mutex_destroy(&semaphore->lock);
+    free(semaphore);
+}
+
+FuriStatus furi_semaphore_acquire(FuriSemaphore* semaphore, uint32_t timeout) {
+    FuriStatus status = FuriStatusOk;
+    pthread_mutex_lock(&semaphore->lock);
+    while(semaphore->count == 0) {
+        if(!wait_for(&semaphore->changed, &semaphore->lock, timeout)) {
+            status = FuriStatusErrorTimeout;
+            break;
+        }
+    }
+    if(status == FuriStatusOk) {
+        semaphore->count--;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return status;
+}
+
+FuriStatus furi_semaphore_release(FuriSemaphore* semaphore) {
+    FuriStatus status = FuriStatusErrorResource;
+    pthread_mutex_lock(&semaphore->lock);
+    if(semaphore->count < semaphore->max) {
+        semaphore->count++;
+        pthread_cond_broadcast(&semaphore->changed);
+        status = FuriStatusOk;
+    }
+    pthread_mutex_unlock(&semaphore->lock);
+    return status;
+}
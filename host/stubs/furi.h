@@ -0,0 +1,174 @@
+/**
+ * @file furi.h
+ * Host stand-in for the parts of furi the app uses
+ *
+ * Strings, records, threads, queues, mutexes and semaphores are real and run on
+ * pthreads. Ticks and timers run on the fake clock in host.h, so tests decide
+ * when time passes.
+ */
+
+#pragma once
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void furi_host_crash(const char* message, const char* file, int line);
+
+#define furi_crash(message) furi_host_crash(message, __FILE__, __LINE__)
+#define furi_check(expr)                                \
+    do {                                                \
+        if(!(expr)) {                                   \
+            furi_host_crash(#expr, __FILE__, __LINE__); \
+        }                                               \
+    } while(0)
+#define furi_assert(expr) furi_check(expr)
+
+#define UNUSED(x) (void)(x)
+#define COUNT_OF(x) (sizeof(x) / sizeof((x)[0]))
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+
+#define EXT_PATH(path) "/ext/" path
+#define APP_DATA_PATH(path) "/data/" path
+
+void furi_log_print(char level, const char* tag, const char* format, ...);
+
+#define FURI_LOG_E(tag, ...) furi_log_print('E', tag, __VA_ARGS__)
+#define FURI_LOG_W(tag, ...) furi_log_print('W', tag, __VA_ARGS__)
+#define FURI_LOG_I(tag, ...) furi_log_print('I', tag, __VA_ARGS__)
+#define FURI_LOG_D(tag, ...) furi_log_print('D', tag, __VA_ARGS__)
+
+#define FuriWaitForever 0xFFFFFFFFU
+
+typedef enum {
+    FuriStatusOk = 0,
+    FuriStatusError = -1,
+    FuriStatusErrorTimeout = -2,
+    FuriStatusErrorResource = -3,
+    FuriStatusErrorParameter = -4,
+} FuriStatus;
+
+/* strings */
+
+typedef struct FuriString FuriString;
+
+#define FURI_STRING_FAILURE ((size_t)-1)
+
+FuriString* furi_string_alloc(void);
+FuriString* furi_string_alloc_set(const FuriString* source);
+FuriString* furi_string_alloc_set_str(const char* cstr);
+FuriString* furi_string_alloc_printf(const char* format, ...);
+void furi_string_free(FuriString* string);
+void furi_string_reset(FuriString* string);
+void furi_string_set(FuriString* string, const FuriString* source);
+void furi_string_set_str(FuriString* string, const char* cstr);
+void furi_string_set_strn(FuriString* string, const char* cstr, size_t n);
+int furi_string_printf(FuriString* string, const char* format, ...);
+void furi_string_push_back(FuriString* string, char c);
+void furi_string_cat_str(FuriString* string, const char* cstr);
+const char* furi_string_get_cstr(const FuriString* string);
+size_t furi_string_size(const FuriString* string);
+bool furi_string_empty(const FuriString* string);
+bool furi_string_equal(const FuriString* string, const FuriString* other);
+bool furi_string_equal_str(const FuriString* string, const char* cstr);
+bool furi_string_start_with_str(const FuriString* string, const char* start);
+size_t furi_string_search_rchar(const FuriString* string, char c, size_t start);
+void furi_string_left(FuriString* string, size_t index);
+
+/* records */
+
+void* furi_record_open(const char* name);
+void furi_record_close(const char* name);
+
+/* kernel, one tick is one millisecond of the fake clock */
+
+uint32_t furi_get_tick(void);
+uint32_t furi_ms_to_ticks(uint32_t milliseconds);
+/** Lets async infrared TX send for as long, see hostInfraredRun() */
+void furi_delay_ms(uint32_t milliseconds);
+
+/* threads */
+
+typedef struct FuriThread FuriThread;
+typedef int32_t (*FuriThreadCallback)(void* context);
+
+typedef enum {
+    FuriThreadPriorityNone = 0,
+    FuriThreadPriorityIdle = 1,
+    FuriThreadPriorityLowest = 14,
+    FuriThreadPriorityLow = 15,
+    FuriThreadPriorityNormal = 16,
+    FuriThreadPriorityHigh = 17,
+    FuriThreadPriorityHighest = 18,
+} FuriThreadPriority;
+
+FuriThread* furi_thread_alloc_ex(
+    const char* name,
+    uint32_t stack_size,
+    FuriThreadCallback callback,
+    void* context);
+void furi_thread_free(FuriThread* thread);
+void furi_thread_set_priority(FuriThread* thread, FuriThreadPriority priority);
+void furi_thread_start(FuriThread* thread);
+bool furi_thread_join(FuriThread* thread);
+
+/* message queues */
+
+typedef struct FuriMessageQueue FuriMessageQueue;
+
+FuriMessageQueue* furi_message_queue_alloc(uint32_t msg_count, uint32_t msg_size);
+void furi_message_queue_free(FuriMessageQueue* queue);
+FuriStatus furi_message_queue_put(FuriMessageQueue* queue, const void* msg, uint32_t timeout);
+FuriStatus furi_message_queue_get(FuriMessageQueue* queue, void* msg, uint32_t timeout);
+
+/* mutexes */
+
+typedef struct FuriMutex FuriMutex;
+
+typedef enum {
+    FuriMutexTypeNormal,
+    FuriMutexTypeRecursive,
+} FuriMutexType;
+
+FuriMutex* furi_mutex_alloc(FuriMutexType type);
+void furi_mutex_free(FuriMutex* mutex);
+FuriStatus furi_mutex_acquire(FuriMutex* mutex, uint32_t timeout);
+FuriStatus furi_mutex_release(FuriMutex* mutex);
+
+/* semaphores */
+
+typedef struct FuriSemaphore FuriSemaphore;
+
+FuriSemaphore* furi_semaphore_alloc(uint32_t max_count, uint32_t initial_count);
+void furi_semaphore_free(FuriSemaphore* semaphore);
+FuriStatus furi_semaphore_acquire(FuriSemaphore* semaphore, uint32_t timeout);
+FuriStatus furi_semaphore_release(FuriSemaphore* semaphore);
+
+/* timers, fired by hostClockAdvance() */
+
+typedef struct FuriTimer FuriTimer;
+typedef void (*FuriTimerCallback)(void* context);
+
+typedef enum {
+    FuriTimerTypeOnce,
+    FuriTimerTypePeriodic,
+} FuriTimerType;
+
+FuriTimer* furi_timer_alloc(FuriTimerCallback func, FuriTimerType type, void* context);
+void furi_timer_free(FuriTimer* timer);
+FuriStatus furi_timer_start(FuriTimer* timer, uint32_t ticks);
+FuriStatus furi_timer_stop(FuriTimer* timer);
+uint32_t furi_timer_is_running(FuriTimer* timer);
+
+#ifdef __cplusplus
+}
+#endif
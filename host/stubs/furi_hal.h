@@ -0,0 +1,20 @@
+#pragma once
+
+#include <furi_hal_resources.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//the cycle counter of the Cortex-M4, it never moves on the host
+typedef struct {
+    uint32_t CYCCNT;
+} DWT_Type;
+
+extern DWT_Type* DWT;
+
+uint32_t furi_hal_cortex_instructions_per_microsecond(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    FuriHalInfraredTxGetDataStateOk,
+    FuriHalInfraredTxGetDataStateDone,
+    FuriHalInfraredTxGetDataStateLastDone,
+} FuriHalInfraredTxGetDataState;
+
+typedef FuriHalInfraredTxGetDataState (
+    *FuriHalInfraredTxGetDataISRCallback)(void* context, uint32_t* duration, bool* level);
+
+/** On the host the interrupt only runs in hostInfraredPull() and friends, see host.h */
+void furi_hal_infrared_async_tx_set_data_isr_callback(
+    FuriHalInfraredTxGetDataISRCallback callback,
+    void* context);
+void furi_hal_infrared_async_tx_start(uint32_t freq, float duty_cycle);
+void furi_hal_infrared_async_tx_wait_termination(void);
+bool furi_hal_infrared_is_busy(void);
+
+#ifdef __cplusplus
+}
+#endif
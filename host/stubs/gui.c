@@ -0,0 +1,335 @@
+#include <dialogs/dialogs.h>
+#include <fancy_remote_icons.h>
+#include <gui/canvas_i.h>
+#include <gui/elements.h>
+#include <gui/view_dispatcher.h>
+#include <notification/notification_messages.h>
+
+#include <pthread.h>
+
+#include "host.h"
+
+/* icons, only their size and whether they are the selected look matter */
+
+const Icon I_ir_10px = {10, 10, false};
+const Icon I_navdown_24x18 = {24, 18, false};
+const Icon I_navdown_hover_24x18 = {24, 18, true};
+const Icon I_navleft_18x24 = {18, 24, false};
+const Icon I_navleft_hover_18x24 = {18, 24, true};
+const Icon I_navok_24x24 = {24, 24, false};
+const Icon I_navok_hover_24x24 = {24, 24, true};
+const Icon I_navright_18x24 = {18, 24, false};
+const Icon I_navright_hover_18x24 = {18, 24, true};
+const Icon I_navup_24x18 = {24, 18, false};
+const Icon I_navup_hover_24x18 = {24, 18, true};
+const Icon I_power_19x20 = {19, 20, false};
+const Icon I_power_hover_19x20 = {19, 20, true};
+const Icon I_power_text_24x5 = {24, 5, false};
+const Icon I_vol_tv_text_29x34 = {29, 34, false};
+const Icon I_voldown_24x21 = {24, 21, false};
+const Icon I_voldown_hover_24x21 = {24, 21, true};
+const Icon I_volup_24x21 = {24, 21, false};
+const Icon I_volup_hover_24x21 = {24, 21, true};
+
+uint16_t icon_get_width(const Icon* instance) {
+    return instance->width;
+}
+
+uint16_t icon_get_height(const Icon* instance) {
+    return instance->height;
+}
+
+/* canvas, a 1 bit frame buffer in rows of 8 pixel pages like the display */
+
+#define HOST_CANVAS_WIDTH 64
+#define HOST_CANVAS_HEIGHT 128
+
+struct Canvas {
+    uint8_t buffer[HOST_CANVAS_WIDTH * HOST_CANVAS_HEIGHT / 8];
+    Color color;
+    HostCanvasCalls calls;
+};
+
+Canvas* hostCanvasAlloc(void) {
+    return calloc(1, sizeof(Canvas));
+}
+
+void hostCanvasFree(Canvas* canvas) {
+    free(canvas);
+}
+
+HostCanvasCalls hostCanvasCalls(const Canvas* canvas) {
+    return canvas->calls;
+}
+
+void hostCanvasResetCalls(Canvas* canvas) {
+    memset(&canvas->calls, 0, sizeof(canvas->calls));
+}
+
+uint8_t* canvas_get_buffer(Canvas* canvas) {
+    return canvas->buffer;
+}
+
+size_t canvas_get_buffer_size(const Canvas* canvas) {
+    return sizeof(canvas->buffer);
+}
+
+void canvas_clear(Canvas* canvas) {
+    canvas->calls.clear++;
+    memset(canvas->buffer, 0, sizeof(canvas->buffer));
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+    canvas->color = color;
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    UNUSED(canvas);
+    UNUSED(font);
+}
+
+//paints a clipped rectangle in the current color
+static void canvas_fill(Canvas* canvas, int32_t x, int32_t y, int32_t width, int32_t height) {
+    int32_t x_end = MIN(x + width, HOST_CANVAS_WIDTH);
+    int32_t y_end = MIN(y + height, HOST_CANVAS_HEIGHT);
+    for(int32_t py = MAX(y, 0); py < y_end; py++) {
+        for(int32_t px = MAX(x, 0); px < x_end; px++) {
+            uint8_t* page = &canvas->buffer[(py / 8) * HOST_CANVAS_WIDTH + px];
+            uint8_t bit = 1 << (py % 8);
+            if(canvas->color == ColorBlack) {
+                *page |= bit;
+            } else if(canvas->color == ColorWhite) {
+                *page &= ~bit;
+            } else {
+                *page ^= bit;
+            }
+        }
+    }
+}
+
+void canvas_draw_str(Canvas* canvas, int32_t x, int32_t y, const char* str) {
+    canvas->calls.str++;
+    UNUSED(x);
+    UNUSED(y);
+    UNUSED(str);
+}
+
+//hover icons are filled and the others outlined, so a frame shows which button is selected
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon) {
+    canvas->calls.icon++;
+    if(icon->hover) {
+        canvas_fill(canvas, x, y, icon->width, icon->height);
+        return;
+    }
+    canvas_fill(canvas, x, y, icon->width, 1);
+    canvas_fill(canvas, x, y + icon->height - 1, icon->width, 1);
+    canvas_fill(canvas, x, y, 1, icon->height);
+    canvas_fill(canvas, x + icon->width - 1, y, 1, icon->height);
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    canvas->calls.box++;
+    canvas_fill(canvas, x, y, width, height);
+}
+
+/* views */
+
+struct View {
+    ViewDrawCallback draw_callback;
+    ViewInputCallback input_callback;
+    void* context;
+    ViewModelType model_type;
+    void* model;
+    pthread_mutex_t model_lock;
+};
+
+View* view_alloc(void) {
+    View* view = calloc(1, sizeof(View));
+    pthread_mutex_init(&view->model_lock, NULL);
+    return view;
+}
+
+void view_free(View* view) {
+    pthread_mutex_destroy(&view->model_lock);
+    free(view->model);
+    free(view);
+}
+
+void view_set_orientation(View* view, ViewOrientation orientation) {
+    UNUSED(view);
+    UNUSED(orientation);
+}
+
+void view_set_context(View* view, void* context) {
+    view->context = context;
+}
+
+void view_set_draw_callback(View* view, ViewDrawCallback callback) {
+    view->draw_callback = callback;
+}
+
+void view_set_input_callback(View* view, ViewInputCallback callback) {
+    view->input_callback = callback;
+}
+
+void view_allocate_model(View* view, ViewModelType type, size_t size) {
+    furi_check(!view->model && type != ViewModelTypeNone);
+    view->model_type = type;
+    view->model = calloc(1, size);
+}
+
+void* view_get_model(View* view) {
+    if(view->model_type == ViewModelTypeLocking) {
+        pthread_mutex_lock(&view->model_lock);
+    }
+    return view->model;
+}
+
+void view_commit_model(View* view, bool update) {
+    UNUSED(update);
+    if(view->model_type == ViewModelTypeLocking) {
+        pthread_mutex_unlock(&view->model_lock);
+    }
+}
+
+void hostViewDraw(View* view, Canvas* canvas) {
+    furi_check(view->draw_callback);
+    void* model = view_get_model(view);
+    view->draw_callback(canvas, model);
+    view_commit_model(view, false);
+}
+
+bool hostViewInput(View* view, InputKey key, InputType type) {
+    furi_check(view->input_callback);
+    InputEvent event = {.key = key, .type = type};
+    return view->input_callback(&event, view->context);
+}
+
+/* view dispatcher and scene manager, the host never runs the app's event loop */
+
+struct ViewDispatcher {
+    void* context;
+};
+
+ViewDispatcher* view_dispatcher_alloc(void) {
+    return calloc(1, sizeof(ViewDispatcher));
+}
+
+void view_dispatcher_free(ViewDispatcher* view_dispatcher) {
+    free(view_dispatcher);
+}
+
+void view_dispatcher_set_event_callback_context(ViewDispatcher* view_dispatcher, void* context) {
+    view_dispatcher->context = context;
+}
+
+void view_dispatcher_set_custom_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherCustomEventCallback callback) {
+    UNUSED(view_dispatcher);
+    UNUSED(callback);
+}
+
+void view_dispatcher_set_navigation_event_callback(
+    ViewDispatcher* view_dispatcher,
+    ViewDispatcherNavigationEventCallback callback) {
+    UNUSED(view_dispatcher);
+    UNUSED(callback);
+}
+
+void view_dispatcher_send_custom_event(ViewDispatcher* view_dispatcher, uint32_t event) {
+    UNUSED(view_dispatcher);
+    UNUSED(event);
+}
+
+void view_dispatcher_run(ViewDispatcher* view_dispatcher) {
+    UNUSED(view_dispatcher);
+}
+
+void view_dispatcher_add_view(ViewDispatcher* view_dispatcher, uint32_t view_id, View* view) {
+    UNUSED(view_dispatcher);
+    UNUSED(view_id);
+    UNUSED(view);
+}
+
+void view_dispatcher_remove_view(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    UNUSED(view_dispatcher);
+    UNUSED(view_id);
+}
+
+void view_dispatcher_switch_to_view(ViewDispatcher* view_dispatcher, uint32_t view_id) {
+    UNUSED(view_dispatcher);
+    UNUSED(view_id);
+}
+
+void view_dispatcher_attach_to_gui(
+    ViewDispatcher* view_dispatcher,
+    Gui* gui,
+    ViewDispatcherType type) {
+    UNUSED(view_dispatcher);
+    UNUSED(gui);
+    UNUSED(type);
+}
+
+struct SceneManager {
+    const SceneManagerHandlers* handlers;
+    void* context;
+};
+
+SceneManager* scene_manager_alloc(const SceneManagerHandlers* app_scene_handlers, void* context) {
+    SceneManager* scene_manager = calloc(1, sizeof(SceneManager));
+    scene_manager->handlers = app_scene_handlers;
+    scene_manager->context = context;
+    return scene_manager;
+}
+
+void scene_manager_free(SceneManager* scene_manager) {
+    free(scene_manager);
+}
+
+bool scene_manager_handle_custom_event(SceneManager* scene_manager, uint32_t custom_event) {
+    UNUSED(scene_manager);
+    UNUSED(custom_event);
+    return false;
+}
+
+bool scene_manager_handle_back_event(SceneManager* scene_manager) {
+    UNUSED(scene_manager);
+    return false;
+}
+
+void scene_manager_next_scene(SceneManager* scene_manager, uint32_t next_scene_id) {
+    furi_check(next_scene_id < scene_manager->handlers->scene_num);
+}
+
+/* dialogs and notifications */
+
+void dialog_file_browser_set_basic_options(
+    DialogsFileBrowserOptions* options,
+    const char* extension,
+    const Icon* icon) {
+    memset(options, 0, sizeof(DialogsFileBrowserOptions));
+    options->extension = extension;
+    options->icon = icon;
+}
+
+bool dialog_file_browser_show(
+    DialogsApp* context,
+    FuriString* result_path,
+    FuriString* path,
+    const DialogsFileBrowserOptions* options) {
+    UNUSED(context);
+    UNUSED(result_path);
+    UNUSED(path);
+    UNUSED(options);
+    return false;
+}
+
+const NotificationSequence sequence_blink_start_magenta = {NULL};
+const NotificationSequence sequence_blink_magenta_10 = {NULL};
+const NotificationSequence sequence_blink_stop = {NULL};
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence) {
+    UNUSED(app);
+    UNUSED(sequence);
+}
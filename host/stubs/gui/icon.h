@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    const uint16_t width;
+    const uint16_t height;
+    //drawn filled by the stub canvas, other icons are drawn as an outline
+    const bool hover;
+} Icon;
+
+uint16_t icon_get_width(const Icon* instance);
+uint16_t icon_get_height(const Icon* instance);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <furi.h>
+#include <gui/canvas.h>
+#include <input/input.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct View View;
+
+typedef enum {
+    ViewOrientationHorizontal,
+    ViewOrientationHorizontalFlip,
+    ViewOrientationVertical,
+    ViewOrientationVerticalFlip,
+} ViewOrientation;
+
+typedef enum {
+    ViewModelTypeNone,
+    ViewModelTypeLockFree,
+    ViewModelTypeLocking,
+} ViewModelType;
+
+typedef void (*ViewDrawCallback)(Canvas* canvas, void* model);
+typedef bool (*ViewInputCallback)(InputEvent* event, void* context);
+
+View* view_alloc(void);
+void view_free(View* view);
+void view_set_orientation(View* view, ViewOrientation orientation);
+void view_set_context(View* view, void* context);
+void view_set_draw_callback(View* view, ViewDrawCallback callback);
+void view_set_input_callback(View* view, ViewInputCallback callback);
+/** The model is zeroed, like everything the firmware's malloc hands out */
+void view_allocate_model(View* view, ViewModelType type, size_t size);
+/** Locks the model if it is ViewModelTypeLocking */
+void* view_get_model(View* view);
+void view_commit_model(View* view, bool update);
+
+#define with_view_model(view, type, code, update) \
+    {                                             \
+        type = view_get_model(view);              \
+        {code};                                   \
+        view_commit_model(view, update);          \
+    }
+
+#ifdef __cplusplus
+}
+#endif
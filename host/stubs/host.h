@@ -0,0 +1,162 @@
+/**
+ * @file host.h
+ * Hooks into the host stubs for tests and benchmarks
+ *
+ * The fake clock counts microseconds and only moves when told to. Files live
+ * under a root directory on the host, "/ext/x" is <root>/ext/x. The worker and
+ * the canvas record what the app hands them.
+ */
+
+#pragma once
+
+#include <furi.h>
+#include <gui/canvas.h>
+#include <gui/view.h>
+#include <furi_hal_infrared.h>
+#include <infrared_worker.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** FURI_LOG_* calls of a level, 'E', 'W', 'I' or 'D', since the start
+ *
+ * Only debug logs are kept quiet, set FANCY_REMOTE_HOST_DEBUG to print them too.
+ */
+size_t hostLogCount(char level);
+
+/** Microseconds on the fake clock */
+uint64_t hostClockNow(void);
+
+/** Move the fake clock forward, firing every timer that falls due on the way
+ *
+ * Timer callbacks run on the calling thread, like on the timer thread of the
+ * device.
+ *
+ * @param      us    microseconds to move
+ */
+void hostClockAdvance(uint64_t us);
+
+/** Make a fresh directory to hold the files of the app
+ *
+ * @return     the root, removed again by hostStorageCleanup()
+ */
+const char* hostStorageInit(void);
+
+/** Remove the root made by hostStorageInit() and everything in it */
+void hostStorageCleanup(void);
+
+/** Host path of a path of the app, valid until the next call */
+const char* hostStoragePath(const char* path);
+
+/** Draw calls a canvas got since it was last reset */
+typedef struct {
+    uint32_t clear;
+    uint32_t icon;
+    uint32_t box;
+    uint32_t str;
+} HostCanvasCalls;
+
+/** Allocate a 64x128 canvas, the size of the vertical screen */
+Canvas* hostCanvasAlloc(void);
+void hostCanvasFree(Canvas* canvas);
+HostCanvasCalls hostCanvasCalls(const Canvas* canvas);
+void hostCanvasResetCalls(Canvas* canvas);
+
+/** Run the draw callback of a view with its model, like the GUI thread does */
+void hostViewDraw(View* view, Canvas* canvas);
+
+/** Hand an input event to a view, like the view dispatcher does */
+bool hostViewInput(View* view, InputKey key, InputType type);
+
+/** One frame the fake worker sent */
+typedef struct {
+    //fake clock when the frame started
+    uint64_t start;
+    InfraredWorkerGetSignalResponse response;
+    bool isDecoded;
+    //timings of raw frames, the message of decoded ones
+    uint32_t size;
+    uint32_t duration;
+    InfraredMessage message;
+} HostWorkerFrame;
+
+/** Length the fake worker gives every decoded frame, the NEC frame period */
+#define HOST_DECODED_FRAME_US 108000
+
+/** Let a started worker send up to count frames
+ *
+ * Every frame asks the get signal callback first and stops the worker when it
+ * says so. Raw frames take as long as their timings add up to and decoded ones
+ * HOST_DECODED_FRAME_US, the fake clock is moved by that much.
+ *
+ * @param      worker  InfraredWorker instance
+ * @param      count   most frames to send
+ *
+ * @return     frames sent
+ */
+size_t hostWorkerRun(InfraredWorker* worker, size_t count);
+
+/** Frames a worker keeps, clear them before sending more */
+#define HOST_WORKER_MAX_FRAMES 4096
+
+/** Frames sent since the worker was allocated or last cleared */
+size_t hostWorkerFrameCount(const InfraredWorker* worker);
+const HostWorkerFrame* hostWorkerFrame(const InfraredWorker* worker, size_t index);
+void hostWorkerClearFrames(InfraredWorker* worker);
+
+/** Timings of the raw signal the worker is set up with */
+const uint32_t* hostWorkerTimings(const InfraredWorker* worker, size_t* size);
+
+bool hostWorkerIsRunning(const InfraredWorker* worker);
+
+/** One timing the async TX interrupt handed to the hardware */
+typedef struct {
+    uint32_t duration;
+    bool level;
+    FuriHalInfraredTxGetDataState state;
+} HostInfraredTiming;
+
+/** Timings the hardware keeps, clear them before sending more */
+#define HOST_INFRARED_MAX_TIMINGS 65536
+
+/** Let the hardware ask the async TX interrupt for up to count timings
+ *
+ * Stops early when the interrupt returns LastDone, TX is over then.
+ *
+ * @param      count  most timings to send
+ *
+ * @return     timings sent
+ */
+size_t hostInfraredPull(size_t count);
+
+/** Let the hardware send timings adding up to at least us, furi_delay_ms() does this
+ *
+ * @param      us    microseconds to send for
+ */
+void hostInfraredRun(uint64_t us);
+
+/** Whether async TX was started and hasn't sent its last timing yet */
+bool hostInfraredIsRunning(void);
+
+/** Timings sent by async TX since the start or since hostInfraredClear() */
+size_t hostInfraredCount(void);
+HostInfraredTiming hostInfraredGet(size_t index);
+void hostInfraredClear(void);
+
+/** One send that didn't go through the worker */
+typedef struct {
+    uint64_t time;
+    bool isRaw;
+    InfraredMessage message;
+    uint32_t size;
+} HostSend;
+
+/** Sends since the start or since hostSendsClear(), from infrared_send() and friends */
+size_t hostSendCount(void);
+HostSend hostSendGet(size_t index);
+void hostSendsClear(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,327 @@
+#include <infrared.h>
+#include <infrared_transmit.h>
+#include <infrared_worker.h>
+
+#include <pthread.h>
+
+#include "host.h"
+
+/* protocols */
+
+typedef struct {
+    const char* name;
+    uint32_t frequency;
+    float duty_cycle;
+} HostProtocol;
+
+static const HostProtocol host_protocols[InfraredProtocolMAX] = {
+    [InfraredProtocolNEC] = {"NEC", 38000, 0.33f},
+    [InfraredProtocolNECext] = {"NECext", 38000, 0.33f},
+    [InfraredProtocolNEC42] = {"NEC42", 38000, 0.33f},
+    [InfraredProtocolNEC42ext] = {"NEC42ext", 38000, 0.33f},
+    [InfraredProtocolSamsung32] = {"Samsung32", 38000, 0.33f},
+    [InfraredProtocolRC6] = {"RC6", 36000, 0.33f},
+    [InfraredProtocolRC5] = {"RC5", 36000, 0.33f},
+    [InfraredProtocolRC5X] = {"RC5X", 36000, 0.33f},
+    [InfraredProtocolSIRC] = {"SIRC", 40000, 0.33f},
+    [InfraredProtocolSIRC15] = {"SIRC15", 40000, 0.33f},
+    [InfraredProtocolSIRC20] = {"SIRC20", 40000, 0.33f},
+    [InfraredProtocolKaseikyo] = {"Kaseikyo", 37000, 0.33f},
+    [InfraredProtocolRCA] = {"RCA", 38000, 0.33f},
+    [InfraredProtocolPioneer] = {"Pioneer", 40000, 0.33f},
+};
+
+InfraredProtocol infrared_get_protocol_by_name(const char* protocol_name) {
+    for(int i = 0; i < InfraredProtocolMAX; i++) {
+        if(strcmp(host_protocols[i].name, protocol_name) == 0) {
+            return i;
+        }
+    }
+    return InfraredProtocolUnknown;
+}
+
+bool infrared_is_protocol_valid(InfraredProtocol protocol) {
+    return protocol >= 0 && protocol < InfraredProtocolMAX;
+}
+
+const char* infrared_get_protocol_name(InfraredProtocol protocol) {
+    return infrared_is_protocol_valid(protocol) ? host_protocols[protocol].name : "Invalid";
+}
+
+uint32_t infrared_get_protocol_frequency(InfraredProtocol protocol) {
+    return infrared_is_protocol_valid(protocol) ? host_protocols[protocol].frequency : 0;
+}
+
+float infrared_get_protocol_duty_cycle(InfraredProtocol protocol) {
+    return infrared_is_protocol_valid(protocol) ? host_protocols[protocol].duty_cycle : 0;
+}
+
+/* single sends, recorded with the fake clock */
+
+static pthread_mutex_t send_lock = PTHREAD_MUTEX_INITIALIZER;
+static HostSend* sends;
+static size_t send_count;
+static size_t send_capacity;
+
+static void host_send_record(const HostSend* send) {
+    pthread_mutex_lock(&send_lock);
+    if(send_count == send_capacity) {
+        send_capacity = send_capacity ? send_capacity * 2 : 64;
+        sends = realloc(sends, sizeof(HostSend) * send_capacity);
+    }
+    sends[send_count++] = *send;
+    pthread_mutex_unlock(&send_lock);
+}
+
+size_t hostSendCount(void) {
+    pthread_mutex_lock(&send_lock);
+    size_t count = send_count;
+    pthread_mutex_unlock(&send_lock);
+    return count;
+}
+
+HostSend hostSendGet(size_t index) {
+    pthread_mutex_lock(&send_lock);
+    furi_check(index < send_count);
+    HostSend send = sends[index];
+    pthread_mutex_unlock(&send_lock);
+    return send;
+}
+
+void hostSendsClear(void) {
+    pthread_mutex_lock(&send_lock);
+    send_count = 0;
+    pthread_mutex_unlock(&send_lock);
+}
+
+//like the firmware, single sends need the hardware to themselves
+void infrared_send(const InfraredMessage* message, int times) {
+    furi_check(!hostInfraredIsRunning());
+    furi_check(infrared_is_protocol_valid(message->protocol));
+    for(int i = 0; i < times; i++) {
+        HostSend send = {.time = hostClockNow(), .isRaw = false, .message = *message};
+        host_send_record(&send);
+    }
+}
+
+void infrared_send_raw_ext(
+    const uint32_t timings[],
+    uint32_t timings_cnt,
+    bool start_from_mark,
+    uint32_t frequency,
+    float duty_cycle) {
+    furi_check(!hostInfraredIsRunning());
+    furi_check(timings && timings_cnt && start_from_mark);
+    UNUSED(frequency);
+    UNUSED(duty_cycle);
+    HostSend send = {.time = hostClockNow(), .isRaw = true, .size = timings_cnt};
+    host_send_record(&send);
+}
+
+/* async TX, the interrupt runs on whichever thread pulls and never on two at once */
+
+static pthread_mutex_t hardware_lock = PTHREAD_MUTEX_INITIALIZER;
+static FuriHalInfraredTxGetDataISRCallback data_callback;
+static void* data_context;
+static bool tx_running;
+static HostInfraredTiming tx_timings[HOST_INFRARED_MAX_TIMINGS];
+static size_t tx_count;
+
+void furi_hal_infrared_async_tx_set_data_isr_callback(
+    FuriHalInfraredTxGetDataISRCallback callback,
+    void* context) {
+    pthread_mutex_lock(&hardware_lock);
+    furi_check(!tx_running);
+    data_callback = callback;
+    data_context = context;
+    pthread_mutex_unlock(&hardware_lock);
+}
+
+void furi_hal_infrared_async_tx_start(uint32_t freq, float duty_cycle) {
+    furi_check(freq && duty_cycle > 0);
+    pthread_mutex_lock(&hardware_lock);
+    furi_check(data_callback && !tx_running);
+    tx_running = true;
+    pthread_mutex_unlock(&hardware_lock);
+}
+
+//sends one timing, the hardware lock is held
+static uint32_t host_infrared_send(void) {
+    HostInfraredTiming timing = {0};
+    timing.state = data_callback(data_context, &timing.duration, &timing.level);
+    furi_check(tx_count < HOST_INFRARED_MAX_TIMINGS);
+    tx_timings[tx_count++] = timing;
+    if(timing.state == FuriHalInfraredTxGetDataStateLastDone) {
+        tx_running = false;
+    }
+    return timing.duration;
+}
+
+size_t hostInfraredPull(size_t count) {
+    pthread_mutex_lock(&hardware_lock);
+    size_t sent = 0;
+    while(tx_running && sent < count) {
+        host_infrared_send();
+        sent++;
+    }
+    pthread_mutex_unlock(&hardware_lock);
+    return sent;
+}
+
+void hostInfraredRun(uint64_t us) {
+    pthread_mutex_lock(&hardware_lock);
+    uint64_t sent = 0;
+    while(tx_running && sent < us) {
+        sent += host_infrared_send();
+    }
+    pthread_mutex_unlock(&hardware_lock);
+}
+
+void furi_hal_infrared_async_tx_wait_termination(void) {
+    hostInfraredRun(UINT64_MAX);
+}
+
+bool furi_hal_infrared_is_busy(void) {
+    return hostInfraredIsRunning();
+}
+
+bool hostInfraredIsRunning(void) {
+    pthread_mutex_lock(&hardware_lock);
+    bool running = tx_running;
+    pthread_mutex_unlock(&hardware_lock);
+    return running;
+}
+
+size_t hostInfraredCount(void) {
+    pthread_mutex_lock(&hardware_lock);
+    size_t count = tx_count;
+    pthread_mutex_unlock(&hardware_lock);
+    return count;
+}
+
+HostInfraredTiming hostInfraredGet(size_t index) {
+    pthread_mutex_lock(&hardware_lock);
+    furi_check(index < tx_count);
+    HostInfraredTiming timing = tx_timings[index];
+    pthread_mutex_unlock(&hardware_lock);
+    return timing;
+}
+
+void hostInfraredClear(void) {
+    pthread_mutex_lock(&hardware_lock);
+    tx_count = 0;
+    pthread_mutex_unlock(&hardware_lock);
+}
+
+/* worker, only hostWorkerRun() asks for frames */
+
+struct InfraredWorker {
+    InfraredWorkerGetSignalCallback callback;
+    void* context;
+    bool running;
+    bool isDecoded;
+    InfraredMessage message;
+    uint32_t timings[MAX_TIMINGS_AMOUNT];
+    size_t size;
+    //fixed so sending never allocates, tests count allocations
+    HostWorkerFrame frames[HOST_WORKER_MAX_FRAMES];
+    size_t frameCount;
+};
+
+InfraredWorker* infrared_worker_alloc(void) {
+    return calloc(1, sizeof(InfraredWorker));
+}
+
+void infrared_worker_free(InfraredWorker* instance) {
+    furi_check(!instance->running);
+    free(instance);
+}
+
+void infrared_worker_tx_start(InfraredWorker* instance) {
+    furi_check(instance->callback);
+    furi_check(!instance->running);
+    instance->running = true;
+}
+
+void infrared_worker_tx_stop(InfraredWorker* instance) {
+    instance->running = false;
+}
+
+void infrared_worker_tx_set_get_signal_callback(
+    InfraredWorker* instance,
+    InfraredWorkerGetSignalCallback callback,
+    void* context) {
+    instance->callback = callback;
+    instance->context = context;
+}
+
+void infrared_worker_set_raw_signal(
+    InfraredWorker* instance,
+    const uint32_t* timings,
+    size_t timings_cnt,
+    uint32_t frequency,
+    float duty_cycle) {
+    furi_check(timings_cnt > 0 && timings_cnt <= MAX_TIMINGS_AMOUNT);
+    UNUSED(frequency);
+    UNUSED(duty_cycle);
+    memcpy(instance->timings, timings, sizeof(uint32_t) * timings_cnt);
+    instance->size = timings_cnt;
+    instance->isDecoded = false;
+}
+
+void infrared_worker_set_decoded_signal(InfraredWorker* instance, const InfraredMessage* message) {
+    furi_check(infrared_is_protocol_valid(message->protocol));
+    instance->message = *message;
+    instance->isDecoded = true;
+}
+
+size_t hostWorkerRun(InfraredWorker* worker, size_t count) {
+    size_t sent = 0;
+    while(worker->running && sent < count) {
+        InfraredWorkerGetSignalResponse response = worker->callback(worker->context, worker);
+        if(response == InfraredWorkerGetSignalResponseStop) {
+            worker->running = false;
+            break;
+        }
+        HostWorkerFrame frame = {
+            .start = hostClockNow(),
+            .response = response,
+            .isDecoded = worker->isDecoded,
+            .message = worker->message};
+        if(worker->isDecoded) {
+            frame.duration = HOST_DECODED_FRAME_US;
+        } else {
+            frame.size = worker->size;
+            for(size_t i = 0; i < worker->size; i++) {
+                frame.duration += worker->timings[i];
+            }
+        }
+        furi_check(worker->frameCount < HOST_WORKER_MAX_FRAMES);
+        worker->frames[worker->frameCount++] = frame;
+        hostClockAdvance(frame.duration);
+        sent++;
+    }
+    return sent;
+}
+
+size_t hostWorkerFrameCount(const InfraredWorker* worker) {
+    return worker->frameCount;
+}
+
+const HostWorkerFrame* hostWorkerFrame(const InfraredWorker* worker, size_t index) {
+    furi_check(index < worker->frameCount);
+    return &worker->frames[index];
+}
+
+void hostWorkerClearFrames(InfraredWorker* worker) {
+    worker->frameCount = 0;
+}
+
+const uint32_t* hostWorkerTimings(const InfraredWorker* worker, size_t* size) {
+    *size = worker->isDecoded ? 0 : worker->size;
+    return worker->timings;
+}
+
+bool hostWorkerIsRunning(const InfraredWorker* worker) {
+    return worker->running;
+}
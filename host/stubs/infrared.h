@@ -0,0 +1,49 @@
+/**
+ * @file infrared.h
+ * Host infrared protocol table, the names and carriers of the firmware
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    InfraredProtocolUnknown = -1,
+    InfraredProtocolNEC = 0,
+    InfraredProtocolNECext,
+    InfraredProtocolNEC42,
+    InfraredProtocolNEC42ext,
+    InfraredProtocolSamsung32,
+    InfraredProtocolRC6,
+    InfraredProtocolRC5,
+    InfraredProtocolRC5X,
+    InfraredProtocolSIRC,
+    InfraredProtocolSIRC15,
+    InfraredProtocolSIRC20,
+    InfraredProtocolKaseikyo,
+    InfraredProtocolRCA,
+    InfraredProtocolPioneer,
+    InfraredProtocolMAX,
+} InfraredProtocol;
+
+typedef struct {
+    InfraredProtocol protocol;
+    uint32_t address;
+    uint32_t command;
+    bool repeat;
+} InfraredMessage;
+
+InfraredProtocol infrared_get_protocol_by_name(const char* protocol_name);
+const char* infrared_get_protocol_name(InfraredProtocol protocol);
+bool infrared_is_protocol_valid(InfraredProtocol protocol);
+uint32_t infrared_get_protocol_frequency(InfraredProtocol protocol);
+float infrared_get_protocol_duty_cycle(InfraredProtocol protocol);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <infrared.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void infrared_send(const InfraredMessage* message, int times);
+void infrared_send_raw_ext(
+    const uint32_t timings[],
+    uint32_t timings_cnt,
+    bool start_from_mark,
+    uint32_t frequency,
+    float duty_cycle);
+
+#ifdef __cplusplus
+}
+#endif
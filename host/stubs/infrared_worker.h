@@ -0,0 +1,46 @@
+/**
+ * @file infrared_worker.h
+ * Host InfraredWorker, frames are only sent when hostWorkerRun() says so
+ */
+
+#pragma once
+
+#include <infrared.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MAX_TIMINGS_AMOUNT 1024U
+
+typedef struct InfraredWorker InfraredWorker;
+
+typedef enum {
+    InfraredWorkerGetSignalResponseNew,
+    InfraredWorkerGetSignalResponseSame,
+    InfraredWorkerGetSignalResponseStop,
+} InfraredWorkerGetSignalResponse;
+
+typedef InfraredWorkerGetSignalResponse (
+    *InfraredWorkerGetSignalCallback)(void* context, InfraredWorker* instance);
+
+InfraredWorker* infrared_worker_alloc(void);
+void infrared_worker_free(InfraredWorker* instance);
+void infrared_worker_tx_start(InfraredWorker* instance);
+void infrared_worker_tx_stop(InfraredWorker* instance);
+void infrared_worker_tx_set_get_signal_callback(
+    InfraredWorker* instance,
+    InfraredWorkerGetSignalCallback callback,
+    void* context);
+void infrared_worker_set_raw_signal(
+    InfraredWorker* instance,
+    const uint32_t* timings,
+    size_t timings_cnt,
+    uint32_t frequency,
+    float duty_cycle);
+void infrared_worker_set_decoded_signal(InfraredWorker* instance, const InfraredMessage* message);
+
+#ifdef __cplusplus
+}
+#endif
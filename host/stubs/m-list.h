@@ -0,0 +1,45 @@
+/**
+ * @file m-list.h
+ * The bit of M*LIB the panel uses, a list of POD items kept in one growing array
+ *
+ * push_raw appends where M*LIB prepends, nothing here depends on the order.
+ */
+
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+
+#define M_POD_OPLIST ()
+#define LIST_OPLIST(name) ()
+
+#define LIST_DEF(name, type, ...)                                                   \
+    typedef struct {                                                                \
+        type* items;                                                                \
+        size_t size;                                                                \
+        size_t capacity;                                                            \
+    } name##_s;                                                                     \
+    typedef name##_s name##_t[1];                                                   \
+    typedef type name##_subtype_ct;                                                 \
+    static inline void name##_init(name##_t list) {                                 \
+        memset(list, 0, sizeof(name##_s));                                          \
+    }                                                                               \
+    static inline void name##_clear(name##_t list) {                                \
+        free(list->items);                                                          \
+        memset(list, 0, sizeof(name##_s));                                          \
+    }                                                                               \
+    static inline void name##_reset(name##_t list) {                                \
+        list->size = 0;                                                             \
+    }                                                                               \
+    static inline type* name##_push_raw(name##_t list) {                            \
+        if(list->size == list->capacity) {                                          \
+            list->capacity = list->capacity ? list->capacity * 2 : 8;               \
+            list->items = realloc(list->items, sizeof(type) * list->capacity);      \
+        }                                                                           \
+        return &list->items[list->size++];                                          \
+    }
+
+#define M_EACH(item, list, name_t)                                                  \
+    (__typeof__(&(list)->items[0]) item = (list)->items;                            \
+     item != (list)->items + (list)->size;                                          \
+     item++)
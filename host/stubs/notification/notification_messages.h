@@ -0,0 +1,21 @@
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RECORD_NOTIFICATION "notification"
+
+typedef struct NotificationApp NotificationApp;
+typedef struct NotificationMessage NotificationMessage;
+typedef const NotificationMessage* NotificationSequence[];
+
+extern const NotificationSequence sequence_blink_start_magenta;
+extern const NotificationSequence sequence_blink_magenta_10;
+extern const NotificationSequence sequence_blink_stop;
+
+void notification_message(NotificationApp* app, const NotificationSequence* sequence);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,385 @@
+#define _GNU_SOURCE
+#include <flipper_format_i.h>
+#include <storage/storage.h>
+
+#include <ftw.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "host.h"
+
+static char storage_root[PATH_MAX];
+
+const char* hostStorageInit(void) {
+    strcpy(storage_root, "/tmp/fancy_remote_XXXXXX");
+    furi_check(mkdtemp(storage_root));
+    const char* const folders[] = {"/ext", "/ext/infrared", "/data"};
+    for(size_t i = 0; i < COUNT_OF(folders); i++) {
+        furi_check(mkdir(hostStoragePath(folders[i]), 0755) == 0);
+    }
+    return storage_root;
+}
+
+static int storage_remove_entry(
+    const char* path,
+    const struct stat* info,
+    int flag,
+    struct FTW* walk) {
+    UNUSED(info);
+    UNUSED(flag);
+    UNUSED(walk);
+    return remove(path);
+}
+
+void hostStorageCleanup(void) {
+    if(storage_root[0]) {
+        nftw(storage_root, storage_remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+        storage_root[0] = '\0';
+    }
+}
+
+const char* hostStoragePath(const char* path) {
+    static __thread char host_path[PATH_MAX];
+    snprintf(host_path, sizeof(host_path), "%s%s", storage_root, path);
+    return host_path;
+}
+
+/* files */
+
+struct File {
+    FILE* fp;
+};
+
+File* storage_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    return calloc(1, sizeof(File));
+}
+
+void storage_file_free(File* file) {
+    storage_file_close(file);
+    free(file);
+}
+
+bool storage_file_open(
+    File* file,
+    const char* path,
+    FS_AccessMode access_mode,
+    FS_OpenMode open_mode) {
+    const char* host_path = hostStoragePath(path);
+    bool exists = access(host_path, F_OK) == 0;
+    bool write = access_mode & FSAM_WRITE;
+    const char* mode = NULL;
+    if(open_mode == FSOM_OPEN_EXISTING) {
+        mode = exists ? (write ? "r+b" : "rb") : NULL;
+    } else if(open_mode == FSOM_CREATE_NEW) {
+        mode = exists ? NULL : "w+b";
+    } else if(open_mode == FSOM_CREATE_ALWAYS) {
+        mode = "w+b";
+    } else if(open_mode == FSOM_OPEN_APPEND) {
+        mode = "a+b";
+    } else {
+        mode = exists ? "r+b" : "w+b";
+    }
+    file->fp = mode ? fopen(host_path, mode) : NULL;
+    return file->fp != NULL;
+}
+
+bool storage_file_close(File* file) {
+    if(!file->fp) {
+        return false;
+    }
+    fclose(file->fp);
+    file->fp = NULL;
+    return true;
+}
+
+size_t storage_file_read(File* file, void* buff, size_t bytes_to_read) {
+    return file->fp ? fread(buff, 1, bytes_to_read, file->fp) : 0;
+}
+
+size_t storage_file_write(File* file, const void* buff, size_t bytes_to_write) {
+    return file->fp ? fwrite(buff, 1, bytes_to_write, file->fp) : 0;
+}
+
+uint64_t storage_file_size(File* file) {
+    struct stat info;
+    if(!file->fp || fstat(fileno(file->fp), &info) != 0) {
+        return 0;
+    }
+    return info.st_size;
+}
+
+bool storage_file_exists(Storage* storage, const char* path) {
+    FileInfo info;
+    return storage_common_stat(storage, path, &info) == FSE_OK && !(info.flags & 1);
+}
+
+FS_Error storage_common_stat(Storage* storage, const char* path, FileInfo* fileinfo) {
+    UNUSED(storage);
+    struct stat info;
+    if(stat(hostStoragePath(path), &info) != 0) {
+        return FSE_NOT_EXIST;
+    }
+    fileinfo->flags = S_ISDIR(info.st_mode) ? 1 : 0;
+    fileinfo->size = info.st_size;
+    return FSE_OK;
+}
+
+FS_Error storage_common_timestamp(Storage* storage, const char* path, uint32_t* timestamp) {
+    UNUSED(storage);
+    struct stat info;
+    if(stat(hostStoragePath(path), &info) != 0) {
+        return FSE_NOT_EXIST;
+    }
+    *timestamp = info.st_mtime;
+    return FSE_OK;
+}
+
+FS_Error storage_common_remove(Storage* storage, const char* path) {
+    UNUSED(storage);
+    return remove(hostStoragePath(path)) == 0 ? FSE_OK : FSE_NOT_EXIST;
+}
+
+//like FatFs this doesn't replace an existing file
+FS_Error storage_common_rename(Storage* storage, const char* old_path, const char* new_path) {
+    UNUSED(storage);
+    char host_old[PATH_MAX];
+    snprintf(host_old, sizeof(host_old), "%s", hostStoragePath(old_path));
+    const char* host_new = hostStoragePath(new_path);
+    if(access(host_new, F_OK) == 0) {
+        return FSE_EXIST;
+    }
+    return rename(host_old, host_new) == 0 ? FSE_OK : FSE_NOT_EXIST;
+}
+
+/* streams */
+
+struct Stream {
+    FILE* fp;
+};
+
+size_t stream_read(Stream* stream, uint8_t* data, size_t size) {
+    return fread(data, 1, size, stream->fp);
+}
+
+bool stream_seek(Stream* stream, int32_t offset, StreamOffset offset_type) {
+    int whence = offset_type == StreamOffsetFromStart ? SEEK_SET :
+                 offset_type == StreamOffsetFromEnd   ? SEEK_END :
+                                                        SEEK_CUR;
+    return fseek(stream->fp, offset, whence) == 0;
+}
+
+size_t stream_tell(Stream* stream) {
+    return ftell(stream->fp);
+}
+
+bool stream_eof(Stream* stream) {
+    int c = getc(stream->fp);
+    if(c == EOF) {
+        return true;
+    }
+    ungetc(c, stream->fp);
+    return false;
+}
+
+bool stream_read_line(Stream* stream, FuriString* str_result) {
+    furi_string_reset(str_result);
+    int c;
+    while((c = getc_unlocked(stream->fp)) != EOF) {
+        furi_string_push_back(str_result, c);
+        if(c == '\n') {
+            break;
+        }
+    }
+    return !furi_string_empty(str_result);
+}
+
+/* flipper format */
+
+struct FlipperFormat {
+    Stream stream;
+    //value part of the line found last
+    FuriString* line;
+};
+
+FlipperFormat* flipper_format_buffered_file_alloc(Storage* storage) {
+    UNUSED(storage);
+    FlipperFormat* flipper_format = calloc(1, sizeof(FlipperFormat));
+    flipper_format->line = furi_string_alloc();
+    return flipper_format;
+}
+
+bool flipper_format_buffered_file_open_existing(FlipperFormat* flipper_format, const char* path) {
+    flipper_format->stream.fp = fopen(hostStoragePath(path), "rb");
+    return flipper_format->stream.fp != NULL;
+}
+
+bool flipper_format_buffered_file_close(FlipperFormat* flipper_format) {
+    if(!flipper_format->stream.fp) {
+        return false;
+    }
+    fclose(flipper_format->stream.fp);
+    flipper_format->stream.fp = NULL;
+    return true;
+}
+
+void flipper_format_free(FlipperFormat* flipper_format) {
+    flipper_format_buffered_file_close(flipper_format);
+    furi_string_free(flipper_format->line);
+    free(flipper_format);
+}
+
+Stream* flipper_format_get_raw_stream(FlipperFormat* flipper_format) {
+    return &flipper_format->stream;
+}
+
+bool flipper_format_rewind(FlipperFormat* flipper_format) {
+    return stream_seek(&flipper_format->stream, 0, StreamOffsetFromStart);
+}
+
+/*moves from the current position to just after the next "key:" at the start of a line.
+like the firmware it compares a character at a time and skips other lines without keeping
+them, so lines of any length take no memory. comments never match, the search never wraps
+around*/
+static bool flipper_format_find_key(FlipperFormat* flipper_format, const char* key) {
+    FILE* fp = flipper_format->stream.fp;
+    size_t key_size = strlen(key);
+    while(true) {
+        size_t matched = 0;
+        int c = getc_unlocked(fp);
+        while(c != EOF && matched < key_size && c == key[matched]) {
+            matched++;
+            c = getc_unlocked(fp);
+        }
+        if(matched == key_size && c == ':') {
+            return true;
+        }
+        while(c != EOF && c != '\n') {
+            c = getc_unlocked(fp);
+        }
+        if(c == EOF) {
+            return false;
+        }
+    }
+}
+
+//finds key and leaves its value in line, with the stream after it
+static bool flipper_format_seek_to_key(FlipperFormat* flipper_format, const char* key) {
+    FuriString* line = flipper_format->line;
+    if(!flipper_format_find_key(flipper_format, key)) {
+        return false;
+    }
+    stream_read_line(&flipper_format->stream, line);
+    const char* text = furi_string_get_cstr(line);
+    const char* value = text + strspn(text, " ");
+    furi_string_set_strn(line, value, strcspn(value, "\r\n"));
+    return true;
+}
+
+bool flipper_format_read_header(
+    FlipperFormat* flipper_format,
+    FuriString* filetype,
+    uint32_t* version) {
+    return flipper_format_rewind(flipper_format) &&
+           flipper_format_read_string(flipper_format, "Filetype", filetype) &&
+           flipper_format_read_uint32(flipper_format, "Version", version, 1);
+}
+
+bool flipper_format_read_string(FlipperFormat* flipper_format, const char* key, FuriString* data) {
+    if(!flipper_format_seek_to_key(flipper_format, key)) {
+        return false;
+    }
+    furi_string_set(data, flipper_format->line);
+    return true;
+}
+
+//parses count values of the line found last with parse, false if there are fewer
+static bool flipper_format_parse_values(
+    FlipperFormat* flipper_format,
+    uint16_t count,
+    bool (*parse)(const char* text, char** end, void* data, uint16_t index),
+    void* data) {
+    const char* text = furi_string_get_cstr(flipper_format->line);
+    for(uint16_t i = 0; i < count; i++) {
+        while(*text == ' ') {
+            text++;
+        }
+        char* end;
+        if(!*text || !parse(text, &end, data, i) || (*end && *end != ' ')) {
+            return false;
+        }
+        text = end;
+    }
+    return true;
+}
+
+static bool flipper_format_parse_hex(const char* text, char** end, void* data, uint16_t index) {
+    unsigned long value = strtoul(text, end, 16);
+    ((uint8_t*)data)[index] = value;
+    return *end == text + 2;
+}
+
+static bool flipper_format_parse_uint32(const char* text, char** end, void* data, uint16_t index) {
+    ((uint32_t*)data)[index] = strtoul(text, end, 10);
+    return *end != text;
+}
+
+static bool flipper_format_parse_float(const char* text, char** end, void* data, uint16_t index) {
+    ((float*)data)[index] = strtof(text, end);
+    return *end != text;
+}
+
+bool flipper_format_read_hex(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint8_t* data,
+    const uint16_t data_size) {
+    return flipper_format_seek_to_key(flipper_format, key) &&
+           flipper_format_parse_values(flipper_format, data_size, flipper_format_parse_hex, data);
+}
+
+bool flipper_format_read_uint32(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* data,
+    const uint16_t data_size) {
+    return flipper_format_seek_to_key(flipper_format, key) &&
+           flipper_format_parse_values(
+               flipper_format, data_size, flipper_format_parse_uint32, data);
+}
+
+bool flipper_format_read_float(
+    FlipperFormat* flipper_format,
+    const char* key,
+    float* data,
+    const uint16_t data_size) {
+    return flipper_format_seek_to_key(flipper_format, key) &&
+           flipper_format_parse_values(flipper_format, data_size, flipper_format_parse_float, data);
+}
+
+//leaves the stream where it was, like the firmware does
+bool flipper_format_get_value_count(
+    FlipperFormat* flipper_format,
+    const char* key,
+    uint32_t* count) {
+    size_t position = stream_tell(&flipper_format->stream);
+    bool found = flipper_format_find_key(flipper_format, key);
+    if(found) {
+        //counted as they go by, the values aren't kept
+        *count = 0;
+        bool in_value = false;
+        int c;
+        while((c = getc_unlocked(flipper_format->stream.fp)) != EOF && c != '\n' &&
+              c != '\r') {
+            if(c == ' ') {
+                in_value = false;
+            } else if(!in_value) {
+                in_value = true;
+                (*count)++;
+            }
+        }
+    }
+    stream_seek(&flipper_format->stream, position, StreamOffsetFromStart);
+    return found;
+}
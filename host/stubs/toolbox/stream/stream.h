@@ -0,0 +1,26 @@
+#pragma once
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct Stream Stream;
+
+typedef enum {
+    StreamOffsetFromCurrent,
+    StreamOffsetFromStart,
+    StreamOffsetFromEnd,
+} StreamOffset;
+
+size_t stream_read(Stream* stream, uint8_t* data, size_t size);
+bool stream_seek(Stream* stream, int32_t offset, StreamOffset offset_type);
+size_t stream_tell(Stream* stream);
+bool stream_eof(Stream* stream);
+/** Read up to and including the next newline, false if nothing was left */
+bool stream_read_line(Stream* stream, FuriString* str_result);
+
+#ifdef __cplusplus
+}
+#endif
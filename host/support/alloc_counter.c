@@ -0,0 +1,52 @@
+#include "alloc_counter.h"
+
+#include <stdint.h>
+
+//sizes of the first allocations after a reset, the count goes on past them
+#define ALLOC_SIZES 4096
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* pointer, size_t size);
+
+static size_t alloc_count;
+static size_t alloc_sizes[ALLOC_SIZES];
+
+static void allocRecord(size_t size) {
+    size_t at = __atomic_fetch_add(&alloc_count, 1, __ATOMIC_RELAXED);
+    if(at < ALLOC_SIZES) {
+        alloc_sizes[at] = size;
+    }
+}
+
+void* __wrap_malloc(size_t size) {
+    allocRecord(size);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    allocRecord(count * size);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* pointer, size_t size) {
+    allocRecord(size);
+    return __real_realloc(pointer, size);
+}
+
+void allocCounterReset(void) {
+    __atomic_store_n(&alloc_count, 0, __ATOMIC_RELAXED);
+}
+
+size_t allocCount(void) {
+    return __atomic_load_n(&alloc_count, __ATOMIC_RELAXED);
+}
+
+size_t allocCountAtLeast(size_t size) {
+    size_t count = allocCount();
+    size_t out = 0;
+    for(size_t i = 0; i < count && i < ALLOC_SIZES; i++) {
+        out += alloc_sizes[i] >= size;
+    }
+    return out;
+}
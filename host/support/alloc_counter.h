@@ -0,0 +1,29 @@
+/**
+ * @file alloc_counter.h
+ * Counts heap allocations of a test
+ *
+ * Link with fancy_remote_alloc_counter, which wraps malloc, calloc and realloc
+ * of everything in the executable. Allocations made inside libc itself, like
+ * the ones of fopen, aren't seen.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Forget the allocations counted so far */
+void allocCounterReset(void);
+
+/** Allocations since the last reset, a realloc counts as one */
+size_t allocCount(void);
+
+/** Allocations of at least size bytes since the last reset */
+size_t allocCountAtLeast(size_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,23 @@
+/**
+ * @file check.h
+ * Assertions for the host tests
+ *
+ * A failed CHECK prints where it failed and the test carries on, CHECK_DONE()
+ * at the end of main turns the failures into the exit code.
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+static int check_failures;
+
+#define CHECK(expr)                                                             \
+    do {                                                                        \
+        if(!(expr)) {                                                           \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+            check_failures++;                                                   \
+        }                                                                       \
+    } while(0)
+
+#define CHECK_DONE() (check_failures ? 1 : 0)
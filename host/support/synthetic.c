@@ -0,0 +1,86 @@
+#include "synthetic.h"
+
+#include <host.h>
+
+const char* const syntheticLayoutNames[SYNTHETIC_LAYOUT_COUNT] = {
+    "Volume_up",
+    "Volume_down",
+    "Navigate_left",
+    "Navigate_up",
+    "Navigate_right",
+    "Navigate_down",
+    "Power",
+    "Confirm"};
+
+void syntheticName(const SyntheticRemote* remote, size_t index, FuriString* name) {
+    size_t first = remote->count - SYNTHETIC_LAYOUT_COUNT;
+    if(index >= first) {
+        furi_string_set_str(name, syntheticLayoutNames[index - first]);
+    } else {
+        furi_string_printf(name, "Button_%zu", index);
+    }
+}
+
+bool syntheticIsRaw(const SyntheticRemote* remote, size_t index) {
+    return remote->rawEvery && index % remote->rawEvery == remote->rawEvery - 1;
+}
+
+//a NEC header, then marks of 560 with spaces of 560 or 1690 and a long gap every 67
+uint32_t syntheticTiming(size_t i) {
+    size_t bit = i % 68;
+    if(bit == 0) {
+        return 9000;
+    }
+    if(bit == 1) {
+        return 4500;
+    }
+    if(bit == 67) {
+        return 40000;
+    }
+    if(bit % 2 == 0) {
+        return 560;
+    }
+    return (i / 3) % 2 ? 1690 : 560;
+}
+
+uint32_t syntheticCapturedTiming(const SyntheticRemote* remote, size_t index, size_t i) {
+    uint32_t timing = syntheticTiming(i);
+    if(!remote->jitter) {
+        return timing;
+    }
+    //a fixed hash of where the timing is, so a file reads back the same
+    uint32_t hash = (uint32_t)(index * 2654435761u) ^ (uint32_t)(i * 40503u + 0x9E3779B9u);
+    hash ^= hash >> 15;
+    hash *= 0x2C1B3C6Du;
+    hash ^= hash >> 12;
+    return timing - remote->jitter + hash % (2 * remote->jitter + 1);
+}
+
+bool syntheticWrite(const char* path, const SyntheticRemote* remote) {
+    furi_check(remote->count >= SYNTHETIC_LAYOUT_COUNT);
+    FILE* file = fopen(hostStoragePath(path), "w");
+    if(!file) {
+        return false;
+    }
+    FuriString* name = furi_string_alloc();
+    fprintf(file, "Filetype: IR signals file\nVersion: 1\n");
+    for(size_t i = 0; i < remote->count; i++) {
+        syntheticName(remote, i, name);
+        fprintf(file, "# \nname: %s\n", furi_string_get_cstr(name));
+        if(syntheticIsRaw(remote, i)) {
+            fprintf(file, "type: raw\nfrequency: 38000\nduty_cycle: 0.330000\ndata:");
+            for(size_t t = 0; t < remote->rawSize; t++) {
+                fprintf(file, " %lu", (unsigned long)syntheticCapturedTiming(remote, i, t));
+            }
+            fprintf(file, "\n");
+        } else {
+            fprintf(
+                file,
+                "type: parsed\nprotocol: NEC\naddress: %02X 00 00 00\ncommand: %02X 00 00 00\n",
+                (unsigned)(i >> 8) & 0xFF,
+                (unsigned)i & 0xFF);
+        }
+    }
+    furi_string_free(name);
+    return fclose(file) == 0;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file synthetic.h
+ * Made up .ir files of any size for the host tests and benchmarks
+ *
+ * Entries are called Button_0, Button_1 and so on, apart from the last ones,
+ * which are named after the buttons of the built-in TV layout so it finds all
+ * of them at the very end of the file. Parsed entries are NEC with the entry
+ * number as address and command, raw ones a NEC frame padded to their size.
+ */
+
+#pragma once
+
+#include <furi.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Names of the built-in TV layout, in the order of the layout */
+extern const char* const syntheticLayoutNames[];
+#define SYNTHETIC_LAYOUT_COUNT 8
+
+typedef struct {
+    //entries in the file, at least SYNTHETIC_LAYOUT_COUNT
+    size_t count;
+    //every rawEvery-th entry is raw, 0 for none
+    size_t rawEvery;
+    //timings of every raw entry, entries longer than RAW_MAX_TIMINGS are streamed
+    size_t rawSize;
+    //most microseconds a raw timing is moved by, like the jitter of a real capture
+    uint32_t jitter;
+} SyntheticRemote;
+
+/** Write a remote to a path of the app
+ *
+ * @param      path    path like "/ext/infrared/x.ir", see hostStoragePath()
+ * @param      remote  what to write
+ *
+ * @return     false if the file couldn't be written
+ */
+bool syntheticWrite(const char* path, const SyntheticRemote* remote);
+
+/** Name of an entry of the remote
+ *
+ * @param      remote  the remote
+ * @param      index   entry number, from 0
+ * @param      name    set to the name
+ */
+void syntheticName(const SyntheticRemote* remote, size_t index, FuriString* name);
+
+/** Whether an entry of the remote is raw */
+bool syntheticIsRaw(const SyntheticRemote* remote, size_t index);
+
+/** Timing i of every raw entry */
+uint32_t syntheticTiming(size_t i);
+
+/** Timing i of a raw entry as it is written, with the jitter of the remote
+ *
+ * @param      remote  the remote
+ * @param      index   entry number, from 0
+ * @param      i       timing number, from 0
+ *
+ * @return     the timing, the same on every call
+ */
+uint32_t syntheticCapturedTiming(const SyntheticRemote* remote, size_t index, size_t i);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,105 @@
+/*loading decodes raw timings straight into the arena of the remote, which is allocated
+once and kept for the next load, and pressing a button allocates nothing but the worker
+the first time. streamed captures take no memory that grows with their length*/
+#include <extensions/ir_remote.h>
+#include <extensions/ir_transmitter.h>
+#include <host.h>
+
+#include "alloc_counter.h"
+#include "check.h"
+#include "synthetic.h"
+
+#define TEST_PATH EXT_PATH("infrared/alloc.ir")
+#define TEST_CACHE_PATH TEST_PATH ".fancycache"
+#define STREAM_PATH EXT_PATH("infrared/alloc_stream.ir")
+//a data: line of several times this many bytes
+#define STREAM_SIZE 30000
+
+//focus, press and release, with a few frames sent while held
+static void press(Transmitter* transmitter, const Remote* remote, uint32_t index) {
+    const RepeatPolicy policy = {0};
+    stageSignal(transmitter, remote, index);
+    CHECK(startSignal(transmitter, remote, index, &policy));
+    CHECK(hostWorkerRun(transmitter->worker, 3) == 3);
+    stopSignal(transmitter);
+    hostWorkerClearFrames(transmitter->worker);
+}
+
+int main(void) {
+    hostStorageInit();
+    //every other entry raw, among them the biggest kept in memory
+    SyntheticRemote synthetic = {.count = 16, .rawEvery = 2, .rawSize = RAW_MAX_TIMINGS};
+    CHECK(syntheticWrite(TEST_PATH, &synthetic));
+    SignalNames names = {.names = syntheticLayoutNames, .count = SYNTHETIC_LAYOUT_COUNT};
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, TEST_PATH);
+
+    //the signals and timings of the remote take one allocation
+    allocCounterReset();
+    loadSignals(&remote, &names);
+    CHECK(remote.arena.size >= 4 * sizeof(uint16_t) * RAW_MAX_TIMINGS);
+    CHECK(allocCountAtLeast(remote.arena.size) == 1);
+    for(size_t i = 0; i < SYNTHETIC_LAYOUT_COUNT; i++) {
+        CHECK(remote.signals[i].isValid);
+        CHECK(remote.signals[i].isRaw == (i % 2 == 1));
+    }
+
+    //the cache holds a few words per signal more, so the first load from it grows the arena
+    allocCounterReset();
+    loadSignals(&remote, &names);
+    CHECK(allocCountAtLeast(remote.arena.size) <= 1);
+
+    //after that it is reused, loading from the cache or from the .ir file
+    const uint8_t* arena = remote.arena.base;
+    size_t size = remote.arena.size;
+    allocCounterReset();
+    loadSignals(&remote, &names);
+    CHECK(allocCountAtLeast(size) == 0);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    storage_common_remove(storage, TEST_CACHE_PATH);
+    furi_record_close(RECORD_STORAGE);
+    allocCounterReset();
+    loadSignals(&remote, &names);
+    CHECK(allocCountAtLeast(size) == 0);
+    CHECK(remote.arena.base == arena);
+    CHECK(remote.signals[1].isRaw && remote.signals[1].raw.size == RAW_MAX_TIMINGS);
+
+    //the first press allocates the worker, every later one nothing
+    Transmitter transmitter;
+    transmitterInit(&transmitter);
+    allocCounterReset();
+    press(&transmitter, &remote, 1);
+    CHECK(allocCount() == 1);
+    for(int round = 0; round < 3; round++) {
+        for(uint32_t i = 0; i < SYNTHETIC_LAYOUT_COUNT; i++) {
+            allocCounterReset();
+            press(&transmitter, &remote, i);
+            if(allocCount() != 0) {
+                fprintf(stderr, "press of %s allocated\n", syntheticLayoutNames[i]);
+                CHECK(false);
+            }
+        }
+    }
+    transmitterFree(&transmitter);
+    remoteFree(&remote);
+
+    //only where the timings start is kept, the lines are never read whole
+    SyntheticRemote streamed = {
+        .count = SYNTHETIC_LAYOUT_COUNT, .rawEvery = 1, .rawSize = STREAM_SIZE};
+    CHECK(syntheticWrite(STREAM_PATH, &streamed));
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, STREAM_PATH);
+    allocCounterReset();
+    loadSignals(&remote, &names);
+    for(size_t i = 0; i < SYNTHETIC_LAYOUT_COUNT; i++) {
+        CHECK(remote.signals[i].isStreamed && remote.signals[i].raw.size == STREAM_SIZE);
+    }
+    if(allocCountAtLeast(STREAM_SIZE) != 0) {
+        fprintf(stderr, "loading streamed captures made a big allocation\n");
+        CHECK(false);
+    }
+    remoteFree(&remote);
+    hostStorageCleanup();
+    return CHECK_DONE();
+}
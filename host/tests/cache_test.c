@@ -0,0 +1,213 @@
+/*every kind of entry makeBody accepts comes back the same from the sidecar cache, and a
+cache whose scratch can't hold its signals or whose codes are out of range is rebuilt
+from the .ir file*/
+#include <extensions/ir_remote.h>
+#include <host.h>
+
+#include "check.h"
+#include "synthetic.h"
+
+#define TEST_PATH EXT_PATH("infrared/cache.ir")
+#define TEST_CACHE_PATH TEST_PATH ".fancycache"
+//header words, see the cache format in ir_remote.c
+#define HEADER_SCRATCH 6
+#define HEADER_WORDS 7
+
+static const char* const names[] = {
+    "Nec",
+    "Samsung",
+    "Rc6",
+    "Short",
+    "Long_gaps",
+    "Largest",
+    "Spread",
+    "Streamed",
+    "No_frequency",
+    "Missing"};
+
+static void writeRaw(FILE* file, const char* name, size_t size, uint32_t scale) {
+    fprintf(file, "# \nname: %s\ntype: raw\nfrequency: 36000\nduty_cycle: 0.250000\ndata:", name);
+    for(size_t i = 0; i < size; i++) {
+        fprintf(file, " %lu", (unsigned long)(syntheticTiming(i) * scale));
+    }
+    fprintf(file, "\n");
+}
+
+static void writeRemote(void) {
+    FILE* file = fopen(hostStoragePath(TEST_PATH), "w");
+    fprintf(file, "Filetype: IR signals file\nVersion: 1\n");
+    fprintf(
+        file,
+        "# \nname: Nec\ntype: parsed\nprotocol: NEC\naddress: 07 00 00 00\n"
+        "command: 02 00 00 00\n"
+        "# \nname: Samsung\ntype: parsed\nprotocol: Samsung32\naddress: 0E 0E 00 00\n"
+        "command: 0C F3 00 00\n"
+        "# \nname: Rc6\ntype: parsed\nprotocol: RC6\naddress: 00 00 00 00\n"
+        "command: 0C 00 00 00\n");
+    writeRaw(file, "Short", 67, 1);
+    //past 32767us timings are packed with less precision
+    writeRaw(file, "Long_gaps", 135, 5);
+    writeRaw(file, "Largest", RAW_MAX_TIMINGS, 1);
+    //too many different timings for a dictionary
+    fprintf(file, "# \nname: Spread\ntype: raw\nfrequency: 38000\nduty_cycle: 0.330000\ndata:");
+    for(size_t i = 0; i < 40; i++) {
+        fprintf(file, " %lu", (unsigned long)(300 + 100 * i));
+    }
+    fprintf(file, "\n");
+    writeRaw(file, "Streamed", RAW_MAX_TIMINGS + 1, 1);
+    fprintf(file, "# \nname: No_frequency\ntype: raw\nduty_cycle: 0.330000\ndata: 900 450\n");
+    fclose(file);
+}
+
+//everything a Signal holds that the cache has to keep
+static bool sameSignal(const Signal* a, const Signal* b) {
+    if(a->isValid != b->isValid || a->isRaw != b->isRaw || a->isStreamed != b->isStreamed) {
+        return false;
+    }
+    if(!a->isValid) {
+        return true;
+    }
+    if(!a->isRaw) {
+        return a->message.protocol == b->message.protocol &&
+               a->message.address == b->message.address &&
+               a->message.command == b->message.command && a->message.repeat == b->message.repeat;
+    }
+    if(a->raw.frequency != b->raw.frequency || a->raw.duty_cycle != b->raw.duty_cycle ||
+       a->raw.size != b->raw.size) {
+        return false;
+    }
+    if(a->isStreamed) {
+        return a->raw.dataOffset == b->raw.dataOffset;
+    }
+    static uint32_t timingsA[RAW_MAX_TIMINGS], timingsB[RAW_MAX_TIMINGS];
+    expandRawSignal(&a->raw, timingsA);
+    expandRawSignal(&b->raw, timingsB);
+    return memcmp(timingsA, timingsB, sizeof(uint32_t) * a->raw.size) == 0;
+}
+
+//a copy of every signal with its own timings, the arena is reused by the next load
+static Signal* copySignals(const Remote* remote) {
+    Signal* copy = malloc(sizeof(Signal) * remote->count);
+    memcpy(copy, remote->signals, sizeof(Signal) * remote->count);
+    for(size_t i = 0; i < remote->count; i++) {
+        RawSignal* raw = &copy[i].raw;
+        if(copy[i].isRaw && !copy[i].isStreamed) {
+            size_t bytes = sizeof(uint16_t) * (raw->codes ? raw->dictSize : raw->size);
+            raw->data = malloc(bytes);
+            memcpy(raw->data, remote->signals[i].raw.data, bytes);
+            if(raw->codes) {
+                raw->codes = malloc((raw->size + 1) / 2);
+                memcpy(raw->codes, remote->signals[i].raw.codes, (raw->size + 1) / 2);
+            }
+        }
+    }
+    return copy;
+}
+
+static void freeSignals(Signal* signals, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        if(signals[i].isRaw && !signals[i].isStreamed) {
+            free(signals[i].raw.data);
+            free(signals[i].raw.codes);
+        }
+    }
+    free(signals);
+}
+
+static uint32_t readWord(size_t word) {
+    FILE* file = fopen(hostStoragePath(TEST_CACHE_PATH), "rb");
+    uint32_t value = 0;
+    fseek(file, word * sizeof(uint32_t), SEEK_SET);
+    CHECK(fread(&value, sizeof(value), 1, file) == 1);
+    fclose(file);
+    return value;
+}
+
+static void writeWord(size_t word, uint32_t value) {
+    FILE* file = fopen(hostStoragePath(TEST_CACHE_PATH), "r+b");
+    fseek(file, word * sizeof(uint32_t), SEEK_SET);
+    CHECK(fwrite(&value, sizeof(value), 1, file) == 1);
+    fclose(file);
+}
+
+static void checkSame(const Remote* remote, const Signal* parsed) {
+    for(size_t i = 0; i < remote->count; i++) {
+        if(!sameSignal(&parsed[i], &remote->signals[i])) {
+            fprintf(stderr, "%s differs\n", names[i]);
+            CHECK(false);
+        }
+    }
+}
+
+int main(void) {
+    hostStorageInit();
+    writeRemote();
+    SignalNames signalNames = {.names = names, .count = COUNT_OF(names)};
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, TEST_PATH);
+
+    loadSignals(&remote, &signalNames);
+    for(size_t i = 0; i < COUNT_OF(names) - 2; i++) {
+        CHECK(remote.signals[i].isValid);
+    }
+    CHECK(remote.signals[3].raw.codes && !remote.signals[6].raw.codes);
+    CHECK(remote.signals[7].isStreamed);
+    CHECK(!remote.signals[8].isValid && !remote.signals[9].isValid);
+    CHECK(readWord(HEADER_SCRATCH) == RAW_MAX_TIMINGS);
+    Signal* parsed = copySignals(&remote);
+
+    //the command of Nec is the fourth word of its slot, a changed one shows the cache is read
+    const size_t command = HEADER_WORDS + 3;
+    CHECK(readWord(command) == 2);
+    writeWord(command, 3);
+    loadSignals(&remote, &signalNames);
+    CHECK(remote.signals[0].message.command == 3);
+    writeWord(command, 2);
+    loadSignals(&remote, &signalNames);
+    checkSame(&remote, parsed);
+
+    //a scratch too small for the in memory signals throws the cache away
+    writeWord(HEADER_SCRATCH, 67);
+    loadSignals(&remote, &signalNames);
+    checkSame(&remote, parsed);
+    CHECK(readWord(HEADER_SCRATCH) == RAW_MAX_TIMINGS);
+
+    //as does one too big to be real, it would size the arena
+    writeWord(HEADER_SCRATCH, UINT32_MAX);
+    loadSignals(&remote, &signalNames);
+    checkSame(&remote, parsed);
+    CHECK(readWord(HEADER_SCRATCH) == RAW_MAX_TIMINGS);
+
+    //as does a dictionary index past the end of the dictionary, Short follows 3 parsed slots
+    const size_t shortDictSize = HEADER_WORDS + 3 * 4 + 4;
+    uint32_t dictSize = readWord(shortDictSize);
+    CHECK(dictSize == remote.signals[3].raw.dictSize && dictSize < 0xF);
+    const size_t shortCodes = shortDictSize + 1 + (dictSize * sizeof(uint16_t) + 7) / 8 * 2;
+    uint32_t codes;
+    memcpy(&codes, remote.signals[3].raw.codes, sizeof(codes));
+    CHECK(readWord(shortCodes) == codes);
+    writeWord(shortCodes, codes | 0xF);
+    loadSignals(&remote, &signalNames);
+    checkSame(&remote, parsed);
+    CHECK(readWord(shortCodes) == codes);
+    freeSignals(parsed, COUNT_OF(names));
+
+    //without the big in memory signals only a chunk of the streamed one needs room
+    const char* const streamed[] = {"Short", "Streamed"};
+    signalNames = (SignalNames){.names = streamed, .count = COUNT_OF(streamed)};
+    loadSignals(&remote, &signalNames);
+    CHECK(readWord(HEADER_SCRATCH) == RAW_STREAM_CHUNK);
+    parsed = copySignals(&remote);
+    writeWord(HEADER_SCRATCH, RAW_STREAM_CHUNK - 1);
+    loadSignals(&remote, &signalNames);
+    CHECK(remote.signals[1].isStreamed);
+    CHECK(sameSignal(&parsed[0], &remote.signals[0]));
+    CHECK(sameSignal(&parsed[1], &remote.signals[1]));
+    CHECK(readWord(HEADER_SCRATCH) == RAW_STREAM_CHUNK);
+    freeSignals(parsed, COUNT_OF(streamed));
+
+    remoteFree(&remote);
+    hostStorageCleanup();
+    return CHECK_DONE();
+}
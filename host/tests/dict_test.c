@@ -0,0 +1,64 @@
+/*raw signals kept as a dictionary come back within RAW_DICT_TOLERANCE of the capture,
+in at most a quarter of the memory of one 32 bit word per timing*/
+#include <extensions/ir_remote.h>
+#include <host.h>
+
+#include "check.h"
+#include "synthetic.h"
+
+#define TEST_PATH EXT_PATH("infrared/dict.ir")
+
+static uint32_t timings[RAW_MAX_TIMINGS];
+
+static void testJitter(uint32_t jitter, size_t size) {
+    SyntheticRemote synthetic = {
+        .count = SYNTHETIC_LAYOUT_COUNT, .rawEvery = 1, .rawSize = size, .jitter = jitter};
+    CHECK(syntheticWrite(TEST_PATH, &synthetic));
+    SignalNames names = {.names = syntheticLayoutNames, .count = SYNTHETIC_LAYOUT_COUNT};
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, TEST_PATH);
+    //parsed, then read back from the cache
+    for(int load = 0; load < 2; load++) {
+        loadSignals(&remote, &names);
+        for(size_t i = 0; i < SYNTHETIC_LAYOUT_COUNT; i++) {
+            const RawSignal* raw = &remote.signals[i].raw;
+            CHECK(remote.signals[i].isValid && raw->size == size);
+            CHECK(raw->codes && raw->dictSize <= RAW_DICT_MAX);
+            CHECK(sizeof(uint16_t) * raw->dictSize + (raw->size + 1) / 2 <= raw->size);
+            expandRawSignal(raw, timings);
+            size_t errors = 0;
+            for(size_t t = 0; t < size; t++) {
+                uint32_t captured = syntheticCapturedTiming(&synthetic, i, t);
+                //long timings are kept in steps of 128us on top of that
+                uint32_t allowed = captured * RAW_DICT_TOLERANCE / 100;
+                if(captured >= 32768) {
+                    allowed += 128;
+                }
+                uint32_t error = timings[t] > captured ? timings[t] - captured :
+                                                         captured - timings[t];
+                if(error > allowed && errors++ < 5) {
+                    fprintf(
+                        stderr,
+                        "%s %zu is %lu, not %lu\n",
+                        names.names[i],
+                        t,
+                        timings[t],
+                        captured);
+                }
+            }
+            CHECK(errors == 0);
+        }
+    }
+    remoteFree(&remote);
+}
+
+int main(void) {
+    hostStorageInit();
+    testJitter(0, 67);
+    testJitter(0, RAW_MAX_TIMINGS);
+    testJitter(50, 300);
+    testJitter(100, RAW_MAX_TIMINGS);
+    hostStorageCleanup();
+    return CHECK_DONE();
+}
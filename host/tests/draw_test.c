@@ -0,0 +1,257 @@
+/*frames built on the last one look the same as a full redraw of the panel, and only
+draw the two buttons whose selection changed. full redraws only draw the rows on screen,
+even when the grid rows aren't in the order of their pixel rows*/
+#include <extensions/upgraded_button_panel.h>
+#include <fancy_remote_icons.h>
+#include <gui/canvas_i.h>
+#include <host.h>
+
+#include "check.h"
+
+#define COLUMNS 2
+#define ROWS 20
+#define ROW_HEIGHT 26
+#define STEPS 80
+
+static const Icon* const icons[][2] = {
+    {&I_navup_24x18, &I_navup_hover_24x18},
+    {&I_navok_24x24, &I_navok_hover_24x24},
+    {&I_navleft_18x24, &I_navleft_hover_18x24},
+    {&I_power_19x20, &I_power_hover_19x20},
+};
+
+typedef struct {
+    InputKey key;
+    InputType type;
+} Step;
+
+static Step steps[STEPS];
+
+//a tall panel with a gap in it, a decoration and a label
+static UpgradedButtonPanel* makePanel(void) {
+    UpgradedButtonPanel* panel = upgraded_button_panel_alloc();
+    upgraded_button_panel_reserve(panel, COLUMNS, ROWS);
+    upgraded_button_panel_add_icon(panel, 20, 0, &I_power_text_24x5);
+    upgraded_button_panel_add_label(panel, 2, 8, FontSecondary, "TV");
+    size_t index = 0;
+    for(size_t y = 0; y < ROWS; y++) {
+        for(size_t x = 0; x < COLUMNS; x++) {
+            if((y * COLUMNS + x) % 7 == 3) {
+                continue;
+            }
+            const Icon* const* icon = icons[index % COUNT_OF(icons)];
+            upgraded_button_panel_add_item(
+                panel,
+                index++,
+                x,
+                y,
+                2 + x * 32,
+                10 + y * ROW_HEIGHT,
+                icon[0],
+                icon[1],
+                NULL,
+                NULL);
+        }
+    }
+    return panel;
+}
+
+//a frame of a panel that never drew before, so it is drawn in full
+static void drawFresh(size_t count, uint8_t* buffer) {
+    UpgradedButtonPanel* panel = makePanel();
+    View* view = upgraded_button_panel_get_view(panel);
+    for(size_t i = 0; i < count; i++) {
+        hostViewInput(view, steps[i].key, steps[i].type);
+    }
+    Canvas* canvas = hostCanvasAlloc();
+    hostViewDraw(view, canvas);
+    memcpy(buffer, canvas_get_buffer(canvas), canvas_get_buffer_size(canvas));
+    hostCanvasFree(canvas);
+    upgraded_button_panel_free(panel);
+}
+
+#define SHUFFLED_COLUMNS 3
+#define SHUFFLED_ROWS 40
+#define SCREEN_HEIGHT 128
+
+typedef struct {
+    bool used;
+    uint16_t x;
+    uint16_t y;
+    const Icon* const* icon;
+} ShuffledButton;
+
+static ShuffledButton shuffled[SHUFFLED_ROWS][SHUFFLED_COLUMNS];
+
+//grid rows placed at random pixel rows, with buttons of different heights and empty rows.
+//none of them overlap, so the order they are drawn in doesn't matter
+static void shuffleRows(void) {
+    uint16_t order[SHUFFLED_ROWS];
+    for(size_t i = 0; i < SHUFFLED_ROWS; i++) {
+        order[i] = i;
+    }
+    for(size_t i = SHUFFLED_ROWS - 1; i > 0; i--) {
+        size_t j = rand() % (i + 1);
+        uint16_t swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+    }
+    for(size_t y = 0; y < SHUFFLED_ROWS; y++) {
+        for(size_t x = 0; x < SHUFFLED_COLUMNS; x++) {
+            ShuffledButton* button = &shuffled[y][x];
+            button->used = y % 9 != 4 && rand() % 4;
+            button->x = 2 + x * 26;
+            button->y = order[y] * 30 + x * 3;
+            button->icon = icons[rand() % COUNT_OF(icons)];
+        }
+    }
+}
+
+static UpgradedButtonPanel* makeShuffledPanel(void) {
+    UpgradedButtonPanel* panel = upgraded_button_panel_alloc();
+    upgraded_button_panel_reserve(panel, SHUFFLED_COLUMNS, SHUFFLED_ROWS);
+    size_t index = 0;
+    for(size_t y = 0; y < SHUFFLED_ROWS; y++) {
+        for(size_t x = 0; x < SHUFFLED_COLUMNS; x++) {
+            const ShuffledButton* button = &shuffled[y][x];
+            if(button->used) {
+                upgraded_button_panel_add_item(
+                    panel,
+                    index++,
+                    x,
+                    y,
+                    button->x,
+                    button->y,
+                    button->icon[0],
+                    button->icon[1],
+                    NULL,
+                    NULL);
+            }
+        }
+    }
+    return panel;
+}
+
+static uint16_t buttonBottom(const ShuffledButton* button) {
+    return button->y + MAX(icon_get_height(button->icon[0]), icon_get_height(button->icon[1]));
+}
+
+/*selects every button of a fresh panel, which scrolls just far enough down to show it,
+and checks the frame against drawing every button without culling. only the rows that
+reach the screen may be drawn*/
+static void checkShuffled(void) {
+    shuffleRows();
+    Canvas* canvas = hostCanvasAlloc();
+    Canvas* expected = hostCanvasAlloc();
+    size_t size = canvas_get_buffer_size(canvas);
+    for(size_t selectedY = 0; selectedY < SHUFFLED_ROWS; selectedY++) {
+        for(size_t selectedX = 0; selectedX < SHUFFLED_COLUMNS; selectedX++) {
+            const ShuffledButton* selected = &shuffled[selectedY][selectedX];
+            if(!selected->used) {
+                continue;
+            }
+            UpgradedButtonPanel* panel = makeShuffledPanel();
+            upgraded_button_panel_set_selected(panel, selectedX, selectedY);
+            hostViewDraw(upgraded_button_panel_get_view(panel), canvas);
+            uint16_t bottom = buttonBottom(selected);
+            int32_t scroll = bottom > SCREEN_HEIGHT ? bottom - SCREEN_HEIGHT : 0;
+
+            canvas_clear(expected);
+            canvas_set_color(expected, ColorBlack);
+            uint32_t onScreen = 0;
+            for(size_t y = 0; y < SHUFFLED_ROWS; y++) {
+                int32_t rowTop = INT32_MAX, rowBottom = 0;
+                size_t count = 0;
+                for(size_t x = 0; x < SHUFFLED_COLUMNS; x++) {
+                    const ShuffledButton* button = &shuffled[y][x];
+                    if(button->used) {
+                        rowTop = MIN(rowTop, button->y);
+                        rowBottom = MAX(rowBottom, buttonBottom(button));
+                        count++;
+                        const Icon* icon = button->icon[button == selected];
+                        canvas_draw_icon(expected, button->x, button->y - scroll, icon);
+                    }
+                }
+                if(count && rowTop < scroll + SCREEN_HEIGHT && rowBottom > scroll) {
+                    onScreen += count;
+                }
+            }
+            if(memcmp(canvas_get_buffer(canvas), canvas_get_buffer(expected), size) != 0 ||
+               hostCanvasCalls(canvas).icon != onScreen) {
+                fprintf(
+                    stderr,
+                    "selecting %zu %zu drew %lu icons for %lu on screen\n",
+                    selectedX,
+                    selectedY,
+                    hostCanvasCalls(canvas).icon,
+                    onScreen);
+                CHECK(false);
+            }
+            hostCanvasResetCalls(canvas);
+            upgraded_button_panel_free(panel);
+        }
+    }
+    hostCanvasFree(expected);
+    hostCanvasFree(canvas);
+}
+
+int main(void) {
+    srand(14);
+    const InputKey keys[] = {InputKeyUp, InputKeyDown, InputKeyLeft, InputKeyRight};
+    for(size_t i = 0; i < STEPS; i++) {
+        steps[i].key = keys[rand() % COUNT_OF(keys)];
+        //now and then a page, and more downs than ups to get to the bottom
+        steps[i].type = rand() % 8 ? InputTypeShort : InputTypeLong;
+        if(steps[i].key == InputKeyUp && rand() % 2) {
+            steps[i].key = InputKeyDown;
+        }
+    }
+
+    UpgradedButtonPanel* panel = makePanel();
+    View* view = upgraded_button_panel_get_view(panel);
+    Canvas* canvas = hostCanvasAlloc();
+    size_t size = canvas_get_buffer_size(canvas);
+    uint8_t* fresh = malloc(size);
+    uint16_t lastX = UINT16_MAX, lastY = UINT16_MAX;
+    size_t moves = 0, scrolls = 0;
+    for(size_t i = 0; i <= STEPS; i++) {
+        if(i) {
+            hostViewInput(view, steps[i - 1].key, steps[i - 1].type);
+        }
+        uint16_t x, y;
+        upgraded_button_panel_get_selected(panel, &x, &y);
+        //the GUI hands the view a cleared canvas every frame
+        canvas_clear(canvas);
+        hostCanvasResetCalls(canvas);
+        hostViewDraw(view, canvas);
+        HostCanvasCalls calls = hostCanvasCalls(canvas);
+
+        drawFresh(i, fresh);
+        if(memcmp(canvas_get_buffer(canvas), fresh, size) != 0) {
+            fprintf(stderr, "frame %zu differs from a full redraw\n", i);
+            CHECK(false);
+        }
+        if(calls.clear) {
+            //the first frame and frames that scrolled are drawn in full
+            scrolls++;
+        } else if(x != lastX || y != lastY) {
+            CHECK(calls.icon == 2 && calls.box == 2 && calls.str == 0);
+            moves++;
+        } else {
+            CHECK(calls.icon == 0 && calls.box == 0 && calls.str == 0);
+        }
+        lastX = x;
+        lastY = y;
+    }
+    //both kinds of frames were seen
+    CHECK(moves > 10 && scrolls > 2);
+
+    free(fresh);
+    hostCanvasFree(canvas);
+    upgraded_button_panel_free(panel);
+
+    for(size_t round = 0; round < 5; round++) {
+        checkShuffled();
+    }
+    return CHECK_DONE();
+}
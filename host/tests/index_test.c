@@ -0,0 +1,110 @@
+/*names whose hashes collide still resolve to their own entries, names or aliases that
+can't fill their button are reported, and a file changed at the same path is indexed again*/
+#include <extensions/ir_remote.h>
+#include <host.h>
+
+#include "check.h"
+
+#define TEST_PATH EXT_PATH("infrared/index.ir")
+
+uint32_t hashName(const char* name);
+
+typedef struct {
+    uint32_t hash;
+    uint32_t number;
+} NumberedHash;
+
+static int compareHashes(const void* a, const void* b) {
+    const NumberedHash* left = a;
+    const NumberedHash* right = b;
+    return left->hash < right->hash ? -1 : left->hash > right->hash;
+}
+
+//the first two names Key_<n> that share a hash, there are about a hundred among a million
+static bool findCollision(char* first, char* second, size_t size) {
+    const uint32_t count = 1000000;
+    NumberedHash* hashes = malloc(sizeof(NumberedHash) * count);
+    char name[16];
+    for(uint32_t i = 0; i < count; i++) {
+        snprintf(name, sizeof(name), "Key_%lu", (unsigned long)i);
+        hashes[i].hash = hashName(name);
+        hashes[i].number = i;
+    }
+    qsort(hashes, count, sizeof(NumberedHash), compareHashes);
+    bool found = false;
+    for(uint32_t i = 1; i < count && !found; i++) {
+        if(hashes[i].hash == hashes[i - 1].hash) {
+            snprintf(first, size, "Key_%lu", (unsigned long)hashes[i - 1].number);
+            snprintf(second, size, "Key_%lu", (unsigned long)hashes[i].number);
+            found = true;
+        }
+    }
+    free(hashes);
+    return found;
+}
+
+static void writeEntry(FILE* file, const char* name, uint32_t command) {
+    fprintf(
+        file,
+        "# \nname: %s\ntype: parsed\nprotocol: NEC\naddress: 00 00 00 00\n"
+        "command: %02lX 00 00 00\n",
+        name,
+        (unsigned long)command);
+}
+
+int main(void) {
+    hostStorageInit();
+    char first[16], second[16];
+    CHECK(findCollision(first, second, sizeof(first)));
+    CHECK(hashName(first) == hashName(second));
+
+    FILE* file = fopen(hostStoragePath(TEST_PATH), "w");
+    fprintf(file, "Filetype: IR signals file\nVersion: 1\n");
+    writeEntry(file, first, 1);
+    writeEntry(file, second, 2);
+    fclose(file);
+
+    //the second name comes first so a hash only match would pick the wrong entry for it
+    const char* const names[] = {second, first, "Missing"};
+    SignalNames signalNames = {.names = names, .count = COUNT_OF(names)};
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, TEST_PATH);
+    for(int pass = 0; pass < 2; pass++) {
+        //the second pass reads the sidecar cache the first one wrote
+        loadSignals(&remote, &signalNames);
+        CHECK(remote.signals[0].isValid && remote.signals[0].message.command == 2);
+        CHECK(remote.signals[1].isValid && remote.signals[1].message.command == 1);
+        CHECK(!remote.signals[2].isValid);
+    }
+
+    //an alias naming another button and a button listed twice are dropped with a warning
+    const SignalAlias aliases[] = {{first, 2}, {second, 0}, {"Other", 2}};
+    const char* const twice[] = {second, first, second};
+    signalNames = (SignalNames){
+        .names = twice, .count = COUNT_OF(twice), .aliases = aliases, .aliasCount = 3};
+    size_t warnings = hostLogCount('W');
+    loadSignals(&remote, &signalNames);
+    CHECK(hostLogCount('W') - warnings == 2);
+    CHECK(remote.signals[0].isValid && remote.signals[0].message.command == 2);
+    CHECK(remote.signals[1].isValid && remote.signals[1].message.command == 1);
+    CHECK(!remote.signals[2].isValid);
+
+    //the same path with every entry moved and new commands, the cache and index are stale
+    uint32_t indexedSize = remote.index.size;
+    file = fopen(hostStoragePath(TEST_PATH), "w");
+    fprintf(file, "Filetype: IR signals file\nVersion: 1\n");
+    writeEntry(file, "Extra_entry_in_front", 9);
+    writeEntry(file, second, 5);
+    writeEntry(file, first, 6);
+    fclose(file);
+    signalNames = (SignalNames){.names = names, .count = COUNT_OF(names)};
+    loadSignals(&remote, &signalNames);
+    CHECK(remote.index.count == 3 && remote.index.size != indexedSize);
+    CHECK(remote.signals[0].isValid && remote.signals[0].message.command == 5);
+    CHECK(remote.signals[1].isValid && remote.signals[1].message.command == 6);
+    CHECK(!remote.signals[2].isValid);
+    remoteFree(&remote);
+    hostStorageCleanup();
+    return CHECK_DONE();
+}
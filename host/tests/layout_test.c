@@ -0,0 +1,58 @@
+/*layouts are read from their sidecar, and one whose grid the panel couldn't afford falls
+back to the built-in layout*/
+#include <extensions/remote_layout.h>
+#include <host.h>
+
+#include "check.h"
+
+#define TEST_PATH EXT_PATH("infrared/layout.ir")
+#define BUILT_IN_COUNT 8
+
+//a layout of a button in the first cell and one in the cell at x y
+static void writeLayout(uint32_t x, uint32_t y) {
+    FILE* file = fopen(hostStoragePath(TEST_PATH LAYOUT_EXTENSION), "w");
+    fprintf(
+        file,
+        "Filetype: Fancy Remote Layout\nVersion: 1\n"
+        "name: Power\nicon: power\nposition: 0 0 22 0\n"
+        "name: Mute\nicon: navok\nposition: %lu %lu 20 30\n",
+        x,
+        y);
+    fclose(file);
+}
+
+static void checkGrid(RemoteLayout* layout, Storage* storage, uint32_t x, uint32_t y) {
+    writeLayout(x, y);
+    loadLayout(layout, storage, TEST_PATH);
+    if((x + 1) * (y + 1) <= LAYOUT_MAX_CELLS) {
+        CHECK(layout->count == 2);
+        CHECK(layout->gridWidth == x + 1 && layout->gridHeight == y + 1);
+    } else {
+        CHECK(layout->count == BUILT_IN_COUNT);
+        CHECK(layout->gridWidth * layout->gridHeight <= LAYOUT_MAX_CELLS);
+    }
+}
+
+int main(void) {
+    hostStorageInit();
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    RemoteLayout layout;
+    layoutInit(&layout);
+
+    loadLayout(&layout, storage, TEST_PATH);
+    CHECK(layout.count == BUILT_IN_COUNT);
+
+    //up to the cap, one past it in either direction, and the largest cell numbers
+    checkGrid(&layout, storage, 3, 5);
+    checkGrid(&layout, storage, 31, 31);
+    checkGrid(&layout, storage, 32, 31);
+    checkGrid(&layout, storage, 31, 32);
+    checkGrid(&layout, storage, 3, 254);
+    checkGrid(&layout, storage, 4, 254);
+    checkGrid(&layout, storage, 254, 254);
+
+    layoutFree(&layout);
+    furi_record_close(RECORD_STORAGE);
+    hostStorageCleanup();
+    return CHECK_DONE();
+}
@@ -0,0 +1,97 @@
+/*the loader tells the app TX stopped only after it told it TX started, both from its own
+thread, however fast a release follows the press*/
+#include <extensions/ir_loader.h>
+#include <host.h>
+#include <pthread.h>
+
+#include "check.h"
+#include "synthetic.h"
+
+#define TEST_PATH EXT_PATH("infrared/loader.ir")
+#define MAX_EVENTS 16
+
+static char events[MAX_EVENTS + 1];
+static size_t eventCount;
+static pthread_t testThread;
+static bool onTestThread;
+
+static void record(char event) {
+    if(eventCount < MAX_EVENTS) {
+        events[eventCount++] = event;
+    }
+    onTestThread = onTestThread || pthread_equal(pthread_self(), testThread);
+}
+
+static void started(void* context) {
+    UNUSED(context);
+    record('+');
+}
+
+static void stopped(void* context) {
+    UNUSED(context);
+    record('-');
+}
+
+//waits for everything queued so far, an unstage is handled after it
+static void checkEvents(SignalLoader* loader, const char* expected) {
+    loaderUnstage(loader);
+    events[eventCount] = '\0';
+    if(strcmp(events, expected) != 0) {
+        fprintf(stderr, "got events \"%s\", not \"%s\"\n", events, expected);
+        CHECK(false);
+    }
+    CHECK(!onTestThread);
+    eventCount = 0;
+}
+
+int main(void) {
+    hostStorageInit();
+    SyntheticRemote synthetic = {.count = SYNTHETIC_LAYOUT_COUNT};
+    CHECK(syntheticWrite(TEST_PATH, &synthetic));
+    SignalNames names = {.names = syntheticLayoutNames, .count = SYNTHETIC_LAYOUT_COUNT};
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, TEST_PATH);
+    loadSignals(&remote, &names);
+    CHECK(remote.signals[0].isValid);
+
+    testThread = pthread_self();
+    Transmitter transmitter;
+    transmitterInit(&transmitter);
+    SignalLoader* loader = loaderAlloc(&transmitter, started, stopped, NULL);
+    const RepeatPolicy policy = {0};
+
+    //a release queued right behind its press
+    loaderPress(loader, &remote, 0, &policy);
+    loaderRelease(loader);
+    checkEvents(loader, "+-");
+
+    //several presses, each stopped once
+    for(size_t i = 0; i < 3; i++) {
+        loaderStage(loader, &remote, i);
+        loaderPress(loader, &remote, i, &policy);
+        loaderRelease(loader);
+    }
+    checkEvents(loader, "+-+-+-");
+
+    //nothing to stop when the press didn't start TX, or after a second release
+    loaderPress(loader, &remote, remote.count, &policy);
+    loaderRelease(loader);
+    loaderPress(loader, &remote, 1, &policy);
+    loaderRelease(loader);
+    loaderRelease(loader);
+    checkEvents(loader, "+-");
+
+    //switching remotes while a button is held stops TX too
+    loaderPress(loader, &remote, 2, &policy);
+    checkEvents(loader, "+-");
+
+    loaderPress(loader, &remote, 0, &policy);
+    loaderFree(loader);
+    events[eventCount] = '\0';
+    CHECK(strcmp(events, "+") == 0);
+    transmitterFree(&transmitter);
+    remoteFree(&remote);
+    hostStorageCleanup();
+    return CHECK_DONE();
+}
@@ -0,0 +1,238 @@
+/*macro steps are read with +gaps, and sent by the loader thread at the times the fake clock
+says, never by the timer. a step the loader can't take yet is handed over on the next tick,
+and one right after a streamed signal waits for it to be out*/
+#include <extensions/remote_layout.h>
+#include <extensions/ir_loader.h>
+#include <host.h>
+#include <pthread.h>
+
+#include "check.h"
+#include "synthetic.h"
+
+#define TEST_PATH EXT_PATH("infrared/macro.ir")
+#define BUILT_IN_COUNT 8
+#define MAX_SENDS 16
+#define STREAM_PATH EXT_PATH("infrared/macro_stream.ir")
+#define STREAM_SIZE 3000
+
+typedef struct {
+    uint64_t time;
+    uint32_t signal;
+    bool onTimerThread;
+} Send;
+
+static Send sends[MAX_SENDS];
+static size_t sendCount;
+static pthread_t timerThread;
+static SignalLoader* loader;
+static MacroRunner* runner;
+//due callbacks left that say the loader is full
+static size_t refusals;
+static size_t dueCount;
+//false to keep due steps from the loader and send them by hand
+static bool useLoader = true;
+//when set, sends go out like the app sends them
+static const Remote* sendRemote;
+//when set, the loader waits on it after starting TX
+static FuriSemaphore* holdPress;
+
+static void writeLayout(const char* steps) {
+    FILE* file = fopen(hostStoragePath(TEST_PATH LAYOUT_EXTENSION), "w");
+    fprintf(
+        file,
+        "Filetype: Fancy Remote Layout\nVersion: 1\n"
+        "name: Power\nicon: power\nposition: 0 0 22 0\n"
+        "name: 3\nicon: navok\nposition: 0 1 20 30\n"
+        "macro: Movie\nicon: navok\nposition: 0 2 2 60\nsteps: %s\n",
+        steps);
+    fclose(file);
+}
+
+static bool stepDue(void* context) {
+    UNUSED(context);
+    dueCount++;
+    if(refusals) {
+        refusals--;
+        return false;
+    }
+    return !useLoader || loaderMacroStep(loader, runner);
+}
+
+static void recordSend(void* context, uint32_t signal) {
+    UNUSED(context);
+    if(sendCount < MAX_SENDS) {
+        sends[sendCount].time = hostClockNow();
+        sends[sendCount].signal = signal;
+        sends[sendCount].onTimerThread = pthread_equal(pthread_self(), timerThread);
+    }
+    sendCount++;
+    if(sendRemote) {
+        CHECK(sendSignalOnce(sendRemote, signal));
+    }
+}
+
+static void pressStarted(void* context) {
+    UNUSED(context);
+    if(holdPress) {
+        furi_semaphore_acquire(holdPress, FuriWaitForever);
+    }
+}
+
+/*releases a streamed signal and has a parsed one sent by a macro right after, before the
+loader got to the release. the step has to wait for the pass, which must come out whole*/
+static void checkAfterStream(void) {
+    SyntheticRemote synthetic = {
+        .count = SYNTHETIC_LAYOUT_COUNT, .rawEvery = 2, .rawSize = STREAM_SIZE};
+    CHECK(syntheticWrite(STREAM_PATH, &synthetic));
+    SignalNames names = {.names = syntheticLayoutNames, .count = SYNTHETIC_LAYOUT_COUNT};
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, STREAM_PATH);
+    loadSignals(&remote, &names);
+    uint32_t streamed = 0;
+    while(!syntheticIsRaw(&synthetic, streamed)) {
+        streamed++;
+    }
+    uint32_t parsed = 0;
+    while(syntheticIsRaw(&synthetic, parsed)) {
+        parsed++;
+    }
+    CHECK(remote.signals[streamed].isStreamed && !remote.signals[parsed].isRaw);
+
+    const MacroStep step = {.signal = parsed, .repeat = 1};
+    const RepeatPolicy policy = {0};
+    useLoader = true;
+    sendRemote = &remote;
+    sendCount = 0;
+    hostInfraredClear();
+    hostSendsClear();
+    holdPress = furi_semaphore_alloc(1, 0);
+    loaderPress(loader, &remote, streamed, &policy);
+    loaderRelease(loader);
+    macroStart(runner, &step, 1);
+    hostClockAdvance(1000);
+    furi_semaphore_release(holdPress);
+    loaderUnstage(loader);
+
+    CHECK(sendCount == 1 && hostSendCount() == 1);
+    CHECK(!hostInfraredIsRunning());
+    //one pass, the gap after it goes on its last timing
+    CHECK(hostInfraredCount() == STREAM_SIZE + STREAM_SIZE % 2);
+    size_t errors = 0;
+    for(size_t t = 0; t + 1 < MIN(hostInfraredCount(), (size_t)STREAM_SIZE); t++) {
+        if(hostInfraredGet(t).duration != syntheticTiming(t) && errors++ < 5) {
+            fprintf(stderr, "streamed timing %zu is %lu\n", t, hostInfraredGet(t).duration);
+        }
+    }
+    CHECK(errors == 0);
+
+    furi_semaphore_free(holdPress);
+    holdPress = NULL;
+    sendRemote = NULL;
+    remoteFree(&remote);
+}
+
+//moves the fake clock a millisecond at a time, letting the loader send what came due
+static void runFor(uint32_t milliseconds) {
+    for(uint32_t i = 0; i < milliseconds; i++) {
+        hostClockAdvance(1000);
+        //handled after everything queued before it, so after the step too
+        loaderUnstage(loader);
+    }
+}
+
+static void
+    checkSends(uint64_t start, const uint64_t* times, const uint32_t* signals, size_t count) {
+    CHECK(sendCount == count);
+    for(size_t i = 0; i < MIN(count, sendCount); i++) {
+        if(sends[i].time - start != times[i] * 1000 || sends[i].signal != signals[i]) {
+            fprintf(
+                stderr,
+                "send %zu was %lu at %lums, not %lu at %lums\n",
+                i,
+                sends[i].signal,
+                (uint32_t)((sends[i].time - start) / 1000),
+                signals[i],
+                (uint32_t)times[i]);
+            CHECK(false);
+        }
+        CHECK(!sends[i].onTimerThread);
+    }
+}
+
+int main(void) {
+    hostStorageInit();
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    RemoteLayout layout;
+    layoutInit(&layout);
+
+    //a gap needs a + and an entry before it
+    writeLayout("Power +x");
+    loadLayout(&layout, storage, TEST_PATH);
+    CHECK(layout.count == BUILT_IN_COUNT);
+    writeLayout("+100 Power");
+    loadLayout(&layout, storage, TEST_PATH);
+    CHECK(layout.count == BUILT_IN_COUNT);
+
+    //3 is an entry, Mute is only sent by the macro
+    writeLayout("Power +3000 3 +500 Mute*3 +150");
+    loadLayout(&layout, storage, TEST_PATH);
+    CHECK(layout.count == 3 && layout.buttons[2].isMacro);
+    const LayoutButton* macro = &layout.buttons[2];
+    CHECK(macro->stepCount == 3);
+    const MacroStep* steps = &layout.steps[macro->firstStep];
+    CHECK(steps[0].signal == 0 && steps[0].repeat == 1 && steps[0].gap == 3000);
+    CHECK(steps[1].signal == 1 && steps[1].repeat == 1 && steps[1].gap == 500);
+    CHECK(strcmp(layout.names[steps[2].signal], "Mute") == 0);
+    CHECK(steps[2].repeat == 3 && steps[2].gap == 150);
+
+    timerThread = pthread_self();
+    Transmitter transmitter;
+    transmitterInit(&transmitter);
+    loader = loaderAlloc(&transmitter, pressStarted, NULL, NULL);
+    runner = macroRunnerAlloc(stepDue, recordSend, NULL);
+
+    //the first step a tick after the start, every gap from the send before it
+    uint32_t mute = steps[2].signal;
+    uint64_t start = hostClockNow();
+    macroStart(runner, steps, macro->stepCount);
+    runFor(5000);
+    const uint64_t times[] = {1, 3001, 3501, 3651, 3801};
+    const uint32_t signals[] = {0, 1, mute, mute, mute};
+    checkSends(start, times, signals, COUNT_OF(times));
+
+    //a full loader holds the step back a tick every time
+    sendCount = 0;
+    dueCount = 0;
+    refusals = 2;
+    start = hostClockNow();
+    macroStart(runner, steps, macro->stepCount);
+    runFor(3500);
+    const uint64_t lateTimes[] = {3, 3003};
+    checkSends(start, lateTimes, signals, COUNT_OF(lateTimes));
+    CHECK(dueCount == 4);
+
+    //a step handed over twice is sent once, and stopping drops one that was handed over
+    useLoader = false;
+    sendCount = 0;
+    macroStart(runner, steps, macro->stepCount);
+    hostClockAdvance(1000);
+    macroStep(runner);
+    macroStep(runner);
+    CHECK(sendCount == 1);
+    hostClockAdvance(3000 * 1000);
+    macroStop(runner);
+    macroStep(runner);
+    CHECK(sendCount == 1);
+
+    checkAfterStream();
+
+    macroStop(runner);
+    loaderFree(loader);
+    macroRunnerFree(runner);
+    transmitterFree(&transmitter);
+    layoutFree(&layout);
+    furi_record_close(RECORD_STORAGE);
+    hostStorageCleanup();
+    return CHECK_DONE();
+}
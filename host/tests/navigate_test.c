@@ -0,0 +1,161 @@
+/*moves through the neighbour table land where scanning the grid on every key press did,
+on random sparse grids. scanMove is that scan as the panel first had it*/
+#include <extensions/upgraded_button_panel.h>
+#include <fancy_remote_icons.h>
+#include <host.h>
+
+#include "check.h"
+
+#define MAX_SIZE 48
+#define ROW_HEIGHT 12
+
+typedef struct {
+    size_t width;
+    size_t height;
+    bool used[MAX_SIZE][MAX_SIZE];
+} Grid;
+
+/*the old move, up and down look for the first button of the next row from the current
+column on and wrap around, left and right the same in the next column. it stays put if
+that row or column is empty*/
+static void scanMove(const Grid* grid, InputKey key, size_t* x, size_t* y) {
+    bool vertical = key == InputKeyUp || key == InputKeyDown;
+    size_t newX = *x, newY = *y;
+    if(key == InputKeyUp) {
+        if(newY == 0) {
+            return;
+        }
+        --newY;
+    } else if(key == InputKeyDown) {
+        if(newY >= grid->height - 1) {
+            return;
+        }
+        ++newY;
+    } else if(key == InputKeyLeft) {
+        if(newX == 0) {
+            return;
+        }
+        --newX;
+    } else {
+        if(newX >= grid->width - 1) {
+            return;
+        }
+        ++newX;
+    }
+    size_t length = vertical ? grid->width : grid->height;
+    for(size_t i = 0; i < length; ++i) {
+        size_t scanX = vertical ? (*x + i) % grid->width : newX;
+        size_t scanY = vertical ? newY : (*y + i) % grid->height;
+        if(grid->used[scanY][scanX]) {
+            *x = scanX;
+            *y = scanY;
+            return;
+        }
+    }
+}
+
+static void randomGrid(Grid* grid, size_t width, size_t height, unsigned percent) {
+    grid->width = width;
+    grid->height = height;
+    memset(grid->used, 0, sizeof(grid->used));
+    for(size_t y = 0; y < height; y++) {
+        for(size_t x = 0; x < width; x++) {
+            grid->used[y][x] = (unsigned)(rand() % 100) < percent;
+        }
+    }
+}
+
+static UpgradedButtonPanel* makePanel(const Grid* grid) {
+    UpgradedButtonPanel* panel = upgraded_button_panel_alloc();
+    upgraded_button_panel_reserve(panel, grid->width, grid->height);
+    size_t index = 0;
+    for(size_t y = 0; y < grid->height; y++) {
+        for(size_t x = 0; x < grid->width; x++) {
+            if(grid->used[y][x]) {
+                upgraded_button_panel_add_item(
+                    panel,
+                    index++,
+                    x,
+                    y,
+                    2 + (x % 4) * 16,
+                    y * ROW_HEIGHT,
+                    &I_ir_10px,
+                    &I_ir_10px,
+                    NULL,
+                    NULL);
+            }
+        }
+    }
+    return panel;
+}
+
+static bool samePosition(UpgradedButtonPanel* panel, size_t x, size_t y) {
+    uint16_t panelX, panelY;
+    CHECK(upgraded_button_panel_get_selected(panel, &panelX, &panelY));
+    return panelX == x && panelY == y;
+}
+
+static const InputKey keys[] = {InputKeyUp, InputKeyDown, InputKeyLeft, InputKeyRight};
+
+//one move in every direction from every button, then a random walk from the start
+static void checkGrid(const Grid* grid) {
+    UpgradedButtonPanel* panel = makePanel(grid);
+    View* view = upgraded_button_panel_get_view(panel);
+    size_t errors = 0;
+
+    //a fresh panel starts at 0 0 even when that is empty
+    size_t x = 0, y = 0;
+    for(size_t step = 0; step < 200; step++) {
+        InputKey key = keys[rand() % COUNT_OF(keys)];
+        hostViewInput(view, key, InputTypeShort);
+        scanMove(grid, key, &x, &y);
+        if(!samePosition(panel, x, y) && errors++ < 5) {
+            fprintf(stderr, "%zux%zu grid, walk step %zu\n", grid->width, grid->height, step);
+        }
+    }
+
+    for(size_t fromY = 0; fromY < grid->height; fromY++) {
+        for(size_t fromX = 0; fromX < grid->width; fromX++) {
+            if(!grid->used[fromY][fromX]) {
+                continue;
+            }
+            for(size_t k = 0; k < COUNT_OF(keys); k++) {
+                upgraded_button_panel_set_selected(panel, fromX, fromY);
+                CHECK(samePosition(panel, fromX, fromY));
+                x = fromX;
+                y = fromY;
+                hostViewInput(view, keys[k], InputTypeShort);
+                scanMove(grid, keys[k], &x, &y);
+                if(!samePosition(panel, x, y) && errors++ < 5) {
+                    fprintf(
+                        stderr,
+                        "%zux%zu grid, key %d from %zu %zu\n",
+                        grid->width,
+                        grid->height,
+                        keys[k],
+                        fromX,
+                        fromY);
+                }
+            }
+        }
+    }
+    CHECK(errors == 0);
+    upgraded_button_panel_free(panel);
+}
+
+int main(void) {
+    srand(13);
+    static Grid grid;
+    for(size_t round = 0; round < 300; round++) {
+        size_t width = 1 + rand() % 12;
+        size_t height = 1 + rand() % 12;
+        randomGrid(&grid, width, height, 5 + rand() % 60);
+        checkGrid(&grid);
+    }
+    //big and very sparse, rows and columns are mostly empty
+    for(size_t round = 0; round < 10; round++) {
+        randomGrid(&grid, MAX_SIZE, MAX_SIZE, 1 + round % 3);
+        checkGrid(&grid);
+    }
+    return CHECK_DONE();
+}
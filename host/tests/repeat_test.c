@@ -0,0 +1,116 @@
+/*held buttons repeat at the cadence of their policy. raw frames are followed by its gap,
+parsed ones come at the period of their protocol, and both stop after maxFrames*/
+#include <extensions/ir_remote.h>
+#include <extensions/ir_transmitter.h>
+#include <host.h>
+
+#include "check.h"
+#include "synthetic.h"
+
+#define TEST_PATH EXT_PATH("infrared/repeat.ir")
+//frames sent for policies without a limit, the button is still held after them
+#define HELD_FRAMES 12
+
+static uint32_t timings[RAW_MAX_TIMINGS];
+
+/*presses signal index with policy and lets the worker send up to HELD_FRAMES frames.
+checks that each starts when the one before it ended, and returns how many were sent*/
+static size_t press(
+    Transmitter* transmitter,
+    const Remote* remote,
+    uint32_t index,
+    const RepeatPolicy* policy,
+    uint32_t frameUs) {
+    stageSignal(transmitter, remote, index);
+    CHECK(startSignal(transmitter, remote, index, policy));
+    InfraredWorker* worker = transmitter->worker;
+    hostWorkerClearFrames(worker);
+    uint64_t start = hostClockNow();
+    size_t sent = hostWorkerRun(worker, HELD_FRAMES);
+    CHECK(hostWorkerFrameCount(worker) == sent);
+    for(size_t i = 0; i < sent; i++) {
+        const HostWorkerFrame* frame = hostWorkerFrame(worker, i);
+        InfraredWorkerGetSignalResponse response = i ? InfraredWorkerGetSignalResponseSame :
+                                                       InfraredWorkerGetSignalResponseNew;
+        if(frame->start - start != i * frameUs || frame->duration != frameUs ||
+           frame->response != response) {
+            fprintf(
+                stderr,
+                "frame %zu of signal %lu started at %luus for %luus\n",
+                i,
+                index,
+                (uint32_t)(frame->start - start),
+                frame->duration);
+            CHECK(false);
+        }
+    }
+    CHECK(hostWorkerIsRunning(worker) == (sent == HELD_FRAMES));
+    stopSignal(transmitter);
+    CHECK(!hostWorkerIsRunning(worker));
+    return sent;
+}
+
+static void testRaw(size_t size) {
+    SyntheticRemote synthetic = {
+        .count = SYNTHETIC_LAYOUT_COUNT, .rawEvery = 2, .rawSize = size};
+    CHECK(syntheticWrite(TEST_PATH, &synthetic));
+    SignalNames names = {.names = syntheticLayoutNames, .count = SYNTHETIC_LAYOUT_COUNT};
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, TEST_PATH);
+    loadSignals(&remote, &names);
+    uint32_t raw = 0;
+    while(!syntheticIsRaw(&synthetic, raw)) {
+        raw++;
+    }
+    uint32_t decoded = 0;
+    while(syntheticIsRaw(&synthetic, decoded)) {
+        decoded++;
+    }
+    CHECK(remote.signals[raw].isRaw && !remote.signals[raw].isStreamed);
+    CHECK(!remote.signals[decoded].isRaw);
+
+    expandRawSignal(&remote.signals[raw].raw, timings);
+    uint32_t rawUs = 0;
+    for(size_t i = 0; i < size; i++) {
+        rawUs += timings[i];
+    }
+    Transmitter transmitter;
+    transmitterInit(&transmitter);
+
+    //back to back until released, or with the gap after every frame
+    const RepeatPolicy held = {0};
+    CHECK(press(&transmitter, &remote, raw, &held, rawUs) == HELD_FRAMES);
+    const RepeatPolicy gap = {.gap = 150};
+    CHECK(press(&transmitter, &remote, raw, &gap, rawUs + 150000) == HELD_FRAMES);
+    const HostWorkerFrame* frame = hostWorkerFrame(transmitter.worker, 0);
+    CHECK(frame->size == size + size % 2);
+    //a limit stops the worker by itself, and the next press starts over
+    const RepeatPolicy limited = {.gap = 150, .maxFrames = 4};
+    CHECK(press(&transmitter, &remote, raw, &limited, rawUs + 150000) == 4);
+    const RepeatPolicy once = {.maxFrames = 1};
+    CHECK(press(&transmitter, &remote, raw, &once, rawUs) == 1);
+    CHECK(press(&transmitter, &remote, raw, &held, rawUs) == HELD_FRAMES);
+
+    //parsed signals ignore the gap, their repeat code keeps the protocol period
+    CHECK(press(&transmitter, &remote, decoded, &gap, HOST_DECODED_FRAME_US) == HELD_FRAMES);
+    CHECK(press(&transmitter, &remote, decoded, &limited, HOST_DECODED_FRAME_US) == 4);
+    frame = hostWorkerFrame(transmitter.worker, 0);
+    CHECK(frame->isDecoded);
+    const InfraredMessage* message = &remote.signals[decoded].message;
+    CHECK(frame->message.address == message->address);
+    CHECK(frame->message.command == message->command);
+    CHECK(press(&transmitter, &remote, decoded, &once, HOST_DECODED_FRAME_US) == 1);
+
+    transmitterFree(&transmitter);
+    remoteFree(&remote);
+}
+
+int main(void) {
+    hostStorageInit();
+    //an odd count gets the gap as a space of its own, an even one adds it to the last
+    testRaw(67);
+    testRaw(68);
+    hostStorageCleanup();
+    return CHECK_DONE();
+}
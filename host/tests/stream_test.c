@@ -0,0 +1,140 @@
+/*streamed signals go out through async TX as one unbroken sequence of timings per pass,
+with only the gap of their policy between passes and none added when the ring wraps*/
+#include <extensions/ir_remote.h>
+#include <extensions/ir_transmitter.h>
+#include <host.h>
+
+#include "check.h"
+#include "synthetic.h"
+
+#define TEST_PATH EXT_PATH("infrared/stream.ir")
+//timings the hardware takes between two polls of the loader
+#define PULL 100
+
+//sends until TX is over, topping the ring up in between like the loader does
+static void drain(Transmitter* transmitter) {
+    while(hostInfraredIsRunning()) {
+        CHECK(transmitterPoll(transmitter));
+        hostInfraredPull(PULL);
+    }
+    CHECK(!transmitterPoll(transmitter));
+}
+
+/*checks that the hardware got passes copies of size timings, each followed by gap ms,
+and that only the last timing ends TX*/
+static void checkPasses(size_t size, size_t passes, uint32_t gap) {
+    size_t perPass = size + size % 2;
+    CHECK(hostInfraredCount() == perPass * passes);
+    if(hostInfraredCount() != perPass * passes) {
+        fprintf(stderr, "sent %zu timings, not %zu\n", hostInfraredCount(), perPass * passes);
+        return;
+    }
+    size_t errors = 0;
+    for(size_t i = 0; i < hostInfraredCount(); i++) {
+        HostInfraredTiming timing = hostInfraredGet(i);
+        size_t t = i % perPass;
+        uint32_t duration = t < size ? syntheticTiming(t) : 0;
+        FuriHalInfraredTxGetDataState state = FuriHalInfraredTxGetDataStateOk;
+        if(t == perPass - 1) {
+            duration += gap * 1000;
+            state = i == hostInfraredCount() - 1 ? FuriHalInfraredTxGetDataStateLastDone :
+                                                   FuriHalInfraredTxGetDataStateDone;
+        }
+        if(timing.duration != duration || timing.level != (t % 2 == 0) ||
+           timing.state != state) {
+            if(errors++ < 5) {
+                fprintf(
+                    stderr,
+                    "timing %zu is %lu %d %d, not %lu %d %d\n",
+                    i,
+                    timing.duration,
+                    timing.level,
+                    timing.state,
+                    duration,
+                    t % 2 == 0,
+                    state);
+            }
+        }
+    }
+    CHECK(errors == 0);
+}
+
+static void send(Transmitter* transmitter, const Remote* remote, const RepeatPolicy* policy) {
+    hostInfraredClear();
+    stageSignal(transmitter, remote, 0);
+    CHECK(startSignal(transmitter, remote, 0, policy));
+    CHECK(hostInfraredIsRunning());
+}
+
+static void testRemote(size_t size) {
+    SyntheticRemote synthetic = {
+        .count = SYNTHETIC_LAYOUT_COUNT, .rawEvery = 1, .rawSize = size};
+    CHECK(syntheticWrite(TEST_PATH, &synthetic));
+    SignalNames names = {.names = syntheticLayoutNames, .count = SYNTHETIC_LAYOUT_COUNT};
+    Remote remote;
+    remoteInit(&remote);
+    furi_string_set_str(remote.path, TEST_PATH);
+    loadSignals(&remote, &names);
+    CHECK(remote.signals[0].isStreamed && remote.signals[0].raw.size == size);
+    Transmitter transmitter;
+    transmitterInit(&transmitter);
+
+    //a limited press sends its passes and stops by itself
+    RepeatPolicy policy = {.maxFrames = 2};
+    send(&transmitter, &remote, &policy);
+    drain(&transmitter);
+    checkPasses(size, 2, RAW_STREAM_MIN_GAP);
+
+    //a longer gap of the policy is kept
+    policy = (RepeatPolicy){.gap = 150, .maxFrames = 3};
+    send(&transmitter, &remote, &policy);
+    drain(&transmitter);
+    checkPasses(size, 3, 150);
+
+    //released during its second pass, an unlimited press finishes that pass
+    policy = (RepeatPolicy){0};
+    send(&transmitter, &remote, &policy);
+    for(size_t sent = 0; sent < size * 3 / 2; sent += hostInfraredPull(PULL)) {
+        CHECK(transmitterPoll(&transmitter));
+    }
+    stopSignal(&transmitter);
+    CHECK(hostInfraredIsRunning());
+    drain(&transmitter);
+    checkPasses(size, 2, RAW_STREAM_MIN_GAP);
+
+    //the signal stays staged and starts over on the next press
+    CHECK(transmitter.staged == 0);
+    policy = (RepeatPolicy){.maxFrames = 1};
+    send(&transmitter, &remote, &policy);
+    drain(&transmitter);
+    checkPasses(size, 1, RAW_STREAM_MIN_GAP);
+
+    //falling behind sends silence instead of stalling and is warned about
+    size_t warnings = hostLogCount('W');
+    send(&transmitter, &remote, &policy);
+    hostInfraredPull(RAW_STREAM_CHUNK + 3);
+    drain(&transmitter);
+    CHECK(hostLogCount('W') == warnings + 1);
+    CHECK(hostInfraredGet(RAW_STREAM_CHUNK).duration == 1000);
+    CHECK(!hostInfraredGet(RAW_STREAM_CHUNK).level);
+
+    //unstaging waits for a stream that is still going
+    policy = (RepeatPolicy){0};
+    send(&transmitter, &remote, &policy);
+    hostInfraredPull(PULL);
+    unstageSignal(&transmitter);
+    CHECK(!hostInfraredIsRunning());
+    CHECK(hostInfraredGet(hostInfraredCount() - 1).state == FuriHalInfraredTxGetDataStateLastDone);
+
+    transmitterFree(&transmitter);
+    remoteFree(&remote);
+}
+
+int main(void) {
+    hostStorageInit();
+    //ending on a space, which takes the gap, and on a mark, which is followed by it
+    testRemote(3000);
+    testRemote(2501);
+    hostStorageCleanup();
+    return CHECK_DONE();
+}